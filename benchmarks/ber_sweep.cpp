@@ -0,0 +1,258 @@
+// Bit-error-rate sweep
+//
+// Simulates a ZppWrite update over a noisy serial link and prints one CSV line
+// per error model and rate. Frames pass through a channel which flips bits,
+// drops bytes or corrupts bursts of bytes on their way to a simulated device.
+// The device decodes them with a Decoder and answers with ack or nak, its
+// responses pass through the same kind of channel on their way back. The host
+// retransmits a frame on nak, on a corrupt response or after a timeout.
+//
+// Columns
+// - model            bitflip (rate per bit), drop (rate per byte) or burst
+//                    (rate of bursts per byte)
+// - rate             Error rate
+// - frames           Frames sent including retransmissions
+// - retransmissions  Frames sent again
+// - failed           Frames given up after all attempts
+// - undetected       Packets accepted by the device which differ from the
+//                    packet sent
+// - goodput_Bps      Image bytes acknowledged per second
+// - efficiency       Goodput relative to an error-free link
+// - resync_ms        Mean time from a failed attempt to the next acknowledged
+//                    frame
+//
+// Usage
+// ULF_SUSIV2BerSweep [--baud=115200] [--image=65536] [--chunk=256]
+//                    [--latency=1000] [--busy=700] [--timeout=50000]
+//                    [--attempts=16] [--burst=8] [--seed=42]
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+struct Options {
+  uint32_t baud{115'200u};    ///< Baud rate
+  size_t image{65'536uz};     ///< Image size [byte]
+  size_t chunk{256uz};        ///< ZppWrite data size [byte]
+  uint32_t latency{1'000u};   ///< Host turnaround, e.g. USB latency [µs]
+  uint32_t busy{700u};        ///< Device busy per ZppWrite [µs]
+  uint32_t timeout{50'000u};  ///< Response timeout [µs]
+  size_t attempts{16uz};      ///< Attempts per frame
+  double burst{8.0};          ///< Mean burst length [byte]
+  uint64_t seed{42u};         ///< Seed
+};
+
+enum class Model { BitFlip, Drop, Burst };
+
+constexpr std::array models{
+  std::pair{Model::BitFlip, "bitflip"},
+  std::pair{Model::Drop, "drop"},
+  std::pair{Model::Burst, "burst"},
+};
+
+constexpr std::array rates{
+  0.0, 1e-6, 1e-5, 3e-5, 1e-4, 3e-4, 1e-3, 3e-3, 1e-2};
+
+/// Noisy channel, byte by byte
+class Channel {
+public:
+  Channel(Model model, double rate, double burst, uint64_t seed)
+    : _model{model}, _rate{rate}, _burst{1.0 / burst}, _gen{seed} {}
+
+  /// Transmit byte
+  ///
+  /// \param  byte          Byte sent
+  /// \retval uint8_t       Byte received
+  /// \retval std::nullopt  Byte dropped
+  std::optional<uint8_t> operator()(uint8_t byte) {
+    switch (_model) {
+      case Model::BitFlip:
+        for (auto i{0u}; i < 8u; ++i)
+          if (chance(_rate)) byte ^= static_cast<uint8_t>(1u << i);
+        return byte;
+      case Model::Drop:
+        if (chance(_rate)) return std::nullopt;
+        return byte;
+      case Model::Burst:
+        // Gilbert-Elliott, every byte of a burst is random
+        if (!_in_burst) _in_burst = chance(_rate);
+        else _in_burst = !chance(_burst);
+        if (_in_burst) return static_cast<uint8_t>(_gen());
+        return byte;
+    }
+    return byte;
+  }
+
+private:
+  bool chance(double p) {
+    return p > 0.0 && std::uniform_real_distribution{}(_gen) < p;
+  }
+
+  Model _model;
+  double _rate;
+  double _burst;
+  std::mt19937_64 _gen;
+  bool _in_burst{};
+};
+
+struct Result {
+  size_t frames{};
+  size_t retransmissions{};
+  size_t failed{};
+  size_t undetected{};
+  size_t delivered{};
+  size_t resyncs{};
+  double resync_us{};
+  double time_us{};
+
+  double goodput() const {
+    return time_us > 0.0 ? static_cast<double>(delivered) * 1e6 / time_us
+                         : 0.0;
+  }
+};
+
+/// Simulate update of a random image
+Result run(Model model, double rate, Options const& o) {
+  std::mt19937_64 gen{o.seed};
+  std::vector<uint8_t> image(o.image);
+  std::ranges::generate(image, [&] { return static_cast<uint8_t>(gen()); });
+
+  Channel down{model, rate, o.burst, o.seed + 1u};
+  Channel up{model, rate, o.burst, o.seed + 2u};
+  Decoder decoder{inter_byte_timeout(o.baud)};
+  auto const byte_us{10e6 / o.baud};
+  std::array<uint8_t, header_size + max_zppwrite_size> buf;
+  Result r;
+  auto& t{r.time_us};
+
+  for (auto addr{0uz}; addr < size(image); addr += o.chunk) {
+    auto const data{std::span{image}.subspan(
+      addr, std::min(o.chunk, size(image) - addr))};
+    auto const frame{
+      zppwrite2frame(static_cast<uint32_t>(addr), data, buf, 0u, false)};
+    auto const expected{frame.subspan(header_size)};
+    std::optional<double> failed_at;
+
+    auto attempt{0uz};
+    for (; attempt < o.attempts; ++attempt) {
+      r.frames += 1uz;
+      r.retransmissions += attempt > 0uz;
+      auto const start{t};
+
+      // Device answers every packet and every corrupt frame, the host only
+      // looks at the first response and flushes the rest
+      std::optional<Response> resp;
+      auto busy{0.0};
+      for (auto i{0uz}; i < size(frame); ++i) {
+        auto const rx{down(frame[i])};
+        if (!rx) continue;
+        auto const now{static_cast<uint32_t>(
+          t + static_cast<double>(i + 1uz) * byte_us)};
+        std::span<uint8_t const> chunk{&*rx, 1uz};
+        do {
+          auto const packet{decoder.receive(chunk, now)};
+          if (packet && !*packet) continue;
+          if (packet && !std::ranges::equal(**packet, expected))
+            r.undetected += 1uz;
+          if (resp) continue;
+          if (packet) {
+            resp = Response{ack};
+            busy = o.busy;
+          } else resp = Response{nak};
+        } while (!empty(chunk) || (decoder.multi() && decoder.remaining()));
+      }
+      t += static_cast<double>(size(frame)) * byte_us;
+
+      // Response
+      std::optional<bool> ok;
+      if (resp) {
+        t += busy;
+        std::vector<uint8_t> rx;
+        for (auto const byte : *resp) {
+          t += byte_us;
+          if (auto const b{up(byte)}) rx.push_back(*b);
+        }
+        if (!empty(rx)) ok = response2feedback(rx, 0u).has_value();
+      }
+      if (!ok) t += o.timeout;
+      t += o.latency;
+
+      if (ok && *ok) {
+        r.delivered += size(data);
+        if (failed_at) {
+          r.resync_us += t - *failed_at;
+          r.resyncs += 1uz;
+        }
+        break;
+      }
+      if (!failed_at) failed_at = start;
+    }
+    r.failed += attempt == o.attempts;
+  }
+
+  return r;
+}
+
+/// Parse --key=value
+template<typename T>
+bool parse(std::string_view arg, std::string_view key, T& value) {
+  if (!arg.starts_with(key) || size(arg) <= size(key) ||
+      arg[size(key)] != '=')
+    return false;
+  arg.remove_prefix(size(key) + 1uz);
+  return std::from_chars(data(arg), data(arg) + size(arg), value).ec ==
+         std::errc{};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options o;
+  for (auto i{1}; i < argc; ++i) {
+    std::string_view const arg{argv[i]};
+    if (!(parse(arg, "--baud", o.baud) || parse(arg, "--image", o.image) ||
+          parse(arg, "--chunk", o.chunk) ||
+          parse(arg, "--latency", o.latency) || parse(arg, "--busy", o.busy) ||
+          parse(arg, "--timeout", o.timeout) ||
+          parse(arg, "--attempts", o.attempts) ||
+          parse(arg, "--burst", o.burst) || parse(arg, "--seed", o.seed))) {
+      std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+  if (!o.baud || !o.image || !o.chunk || o.chunk > 256uz || !o.attempts ||
+      o.burst < 1.0) {
+    std::fprintf(stderr, "Invalid arguments\n");
+    return 1;
+  }
+
+  auto const ideal{run(Model::BitFlip, 0.0, o).goodput()};
+  std::printf("model,rate,frames,retransmissions,failed,undetected,"
+              "goodput_Bps,efficiency,resync_ms\n");
+  for (auto const& [model, name] : models)
+    for (auto const rate : rates) {
+      auto const r{run(model, rate, o)};
+      std::printf("%s,%g,%zu,%zu,%zu,%zu,%.1f,%.4f,%.3f\n",
+                  name,
+                  rate,
+                  r.frames,
+                  r.retransmissions,
+                  r.failed,
+                  r.undetected,
+                  r.goodput(),
+                  r.goodput() / ideal,
+                  r.resyncs ? r.resync_us / static_cast<double>(r.resyncs) /
+                                1e3
+                            : 0.0);
+    }
+}
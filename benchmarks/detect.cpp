@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <random>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+// CvRead frames
+std::vector<std::array<uint8_t, header_size + cvread_size>> const frames{[] {
+  std::vector<std::array<uint8_t, header_size + cvread_size>> v(1024uz);
+  for (auto i{0u}; i < size(v); ++i) {
+    auto& frame{v[i]};
+    frame = {0x00u, 0x00u, 0x00u, 0x01u, busy_flag, 0x01u};
+    uint32_2data(i, &frame[header_size + zusi::addr_pos]);
+    frame.back() =
+      zusi::crc8(std::span{frame}.subspan(header_size, cvread_size - 1uz));
+  }
+  return v;
+}()};
+
+// Random bytes, optionally with a plausible answer length
+std::vector<std::array<uint8_t, 16uz>> noise(bool plausible) {
+  std::mt19937 gen{42u};
+  std::uniform_int_distribution<uint32_t> dist{0u, 255u};
+  std::vector<std::array<uint8_t, 16uz>> v(65536uz);
+  for (auto& bytes : v) {
+    std::ranges::generate(bytes,
+                          [&] { return static_cast<uint8_t>(dist(gen)); });
+    if (plausible) bytes[0uz] = bytes[1uz] = bytes[2uz] = bytes[3uz] = 0u;
+  }
+  return v;
+}
+
+// Classify from the first 6 bytes
+void detect_header(benchmark::State& state) {
+  for (auto _ : state)
+    for (auto const& frame : frames)
+      benchmark::DoNotOptimize(detect(std::span{frame}.first(6uz)));
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(frames)));
+}
+
+// Classify complete frames
+void detect_frame(benchmark::State& state) {
+  for (auto _ : state)
+    for (auto const& frame : frames) benchmark::DoNotOptimize(detect(frame));
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(frames)));
+}
+
+// Trial parsing with frame2packet as reference
+void trial_parse(benchmark::State& state) {
+  for (auto _ : state)
+    for (auto const& frame : frames)
+      benchmark::DoNotOptimize(frame2packet(frame));
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(frames)));
+}
+
+// Classify noise and count false positives (Medium or High)
+void detect_noise(benchmark::State& state) {
+  auto const bytes{noise(state.range(0))};
+  size_t positives{};
+  for (auto _ : state)
+    for (auto const& b : bytes) {
+      auto const c{detect(b)};
+      benchmark::DoNotOptimize(c);
+      positives += c >= Confidence::Medium;
+    }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(bytes)));
+  state.counters["false_positive_rate"] =
+    static_cast<double>(positives) /
+    static_cast<double>(state.iterations() * size(bytes));
+}
+
+} // namespace
+
+BENCHMARK(detect_header);
+BENCHMARK(detect_frame);
+BENCHMARK(trial_parse);
+BENCHMARK(detect_noise)->Arg(false)->Arg(true);
@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <vector>
+#include "ulf/susiv2.hpp"
+#include "ulf/susiv2/frame_cache.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+std::vector<uint8_t> const image(1024uz * 1024uz, 0xA5u);
+
+// Encode every frame of the image for each deployment
+void deploy_encode(benchmark::State& state) {
+  std::array<uint8_t, header_size + max_zppwrite_size> buf{};
+  for (auto _ : state)
+    for (auto addr{0uz}; addr < size(image); addr += 256uz)
+      benchmark::DoNotOptimize(zppwrite2frame(
+        static_cast<uint32_t>(addr), {&image[addr], 256uz}, buf, 0u, false));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(size(image)));
+}
+
+// Open the cache and walk the precompiled frames
+void deploy_cached(benchmark::State& state) {
+  auto const key{make_frame_cache_key(image, 0u)};
+  std::vector<uint8_t> cache(frame_cache_max_size(key));
+  cache.resize(*build_frame_cache(image, key, cache));
+  for (auto _ : state) {
+    auto const view{read_frame_cache(cache, key)};
+    for (auto i{0uz}; i < view->count(); ++i)
+      benchmark::DoNotOptimize((*view)[i]);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(size(image)));
+}
+
+// Build the cache
+void build(benchmark::State& state) {
+  auto const key{make_frame_cache_key(image, 0u)};
+  std::vector<uint8_t> cache(frame_cache_max_size(key));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(build_frame_cache(
+      image, key, cache, static_cast<size_t>(state.range(0))));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(size(image)));
+}
+
+} // namespace
+
+BENCHMARK(deploy_encode);
+BENCHMARK(deploy_cached);
+BENCHMARK(build)->Arg(1)->Arg(4)->UseRealTime();
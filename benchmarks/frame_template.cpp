@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <vector>
+#include <zusi/crc8.hpp>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+std::vector<uint8_t> const image(64uz * 1024uz, 0xA5u);
+
+// Build every ZppWrite frame from scratch
+void zppwrite_from_scratch(benchmark::State& state) {
+  std::array<uint8_t, ULF_SUSIV2_MAX_FRAME_SIZE> frame{};
+  for (auto _ : state) {
+    for (auto addr{0uz}; addr < size(image); addr += 256uz) {
+      uint32_2data(0u, &frame[answer_length_pos]);
+      frame[flags_pos] = busy_flag;
+      auto const packet{std::span{frame}.subspan(header_size)};
+      packet[zusi::cmd_pos] = std::to_underlying(zusi::Command::ZppWrite);
+      packet[zusi::data_cnt_pos] = 0xFFu;
+      uint32_2data(static_cast<uint32_t>(addr), &packet[zusi::addr_pos]);
+      std::ranges::copy_n(&image[addr], 256uz, &packet[zusi::data_pos]);
+      packet[zppwrite_size(0xFFu) - 1uz] =
+        zusi::crc8(packet.first(zppwrite_size(0xFFu) - 1uz));
+      benchmark::DoNotOptimize(frame);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(image) / 256uz));
+}
+
+// Only update address and data of a template
+void zppwrite_from_template(benchmark::State& state) {
+  FrameTemplate tmpl{zusi::Command::ZppWrite, 0xFFu, 0u, true};
+  for (auto _ : state) {
+    for (auto addr{0uz}; addr < size(image); addr += 256uz) {
+      tmpl.address(static_cast<uint32_t>(addr))
+        .data({&image[addr], 256uz});
+      benchmark::DoNotOptimize(tmpl.frame());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(image) / 256uz));
+}
+
+// CV-write sequence writing the same value to consecutive CVs
+void cvwrite_from_scratch(benchmark::State& state) {
+  std::array<uint8_t, header_size + cvwrite_size(0u)> frame{};
+  for (auto _ : state) {
+    for (auto addr{0u}; addr < 1024u; ++addr) {
+      uint32_2data(0u, &frame[answer_length_pos]);
+      frame[flags_pos] = busy_flag;
+      auto const packet{std::span{frame}.subspan(header_size)};
+      packet[zusi::cmd_pos] = std::to_underlying(zusi::Command::CvWrite);
+      packet[zusi::data_cnt_pos] = 0u;
+      uint32_2data(addr, &packet[zusi::addr_pos]);
+      packet[zusi::data_pos] = 42u;
+      packet.back() = zusi::crc8(packet.first(size(packet) - 1uz));
+      benchmark::DoNotOptimize(frame);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+void cvwrite_from_template(benchmark::State& state) {
+  FrameTemplate tmpl{zusi::Command::CvWrite, 0u, 0u, true};
+  std::array<uint8_t, 1uz> const value{42u};
+  tmpl.data(value);
+  for (auto _ : state) {
+    for (auto addr{0u}; addr < 1024u; ++addr)
+      benchmark::DoNotOptimize(tmpl.address(addr).frame());
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+} // namespace
+
+BENCHMARK(zppwrite_from_scratch);
+BENCHMARK(zppwrite_from_template);
+BENCHMARK(cvwrite_from_scratch);
+BENCHMARK(cvwrite_from_template);
@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+// Mix of CvWrite and CvRead packets
+std::vector<std::vector<uint8_t>> const packets{[] {
+  std::vector<std::vector<uint8_t>> v;
+  for (auto i{0u}; i < 1024u; ++i) {
+    std::vector<uint8_t> packet{i % 2u ? uint8_t{0x01u} : uint8_t{0x02u}, 0u};
+    packet.resize(6uz);
+    uint32_2data(i, &packet[zusi::addr_pos]);
+    if (!(i % 2u)) packet.push_back(static_cast<uint8_t>(i));
+    packet.push_back(zusi::crc8(packet));
+    v.push_back(packet);
+  }
+  return v;
+}()};
+
+// Runtime helpers check size and command for each field
+void helpers(benchmark::State& state) {
+  for (auto _ : state) {
+    uint32_t sum{};
+    for (auto const& packet : packets) {
+      auto const cmd{**get_command(packet)};
+      auto const addr{**get_address(packet)};
+      sum += addr;
+      if (cmd == zusi::Command::CvWrite) sum += (**get_data(packet))[0uz];
+      sum += **get_count(packet);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(packets)));
+}
+
+// Typed views dispatch once
+void views(benchmark::State& state) {
+  for (auto _ : state) {
+    uint32_t sum{};
+    for (auto const& packet : packets)
+      sum += visit_packet(
+        []<typename View>(View view) -> uint32_t {
+          if constexpr (View::command == zusi::Command::CvRead)
+            return view.address() + view.count();
+          else if constexpr (View::command == zusi::Command::CvWrite)
+            return view.address() + view.data()[0uz] + view.count();
+          else return 0u;
+        },
+        packet);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(packets)));
+}
+
+} // namespace
+
+BENCHMARK(helpers);
+BENCHMARK(views);
@@ -0,0 +1,128 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <ranges>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+// ZppWrite frames of 1-64 data bytes back to back
+std::vector<uint8_t> const stream{[] {
+  std::vector<uint8_t> v;
+  std::array<uint8_t, 64uz> data{};
+  std::array<uint8_t, header_size + max_zppwrite_size> buf;
+  for (auto i{0uz}; i < 1024uz; ++i) {
+    data.fill(static_cast<uint8_t>(i));
+    auto const frame{zppwrite2frame(static_cast<uint32_t>(i),
+                                    std::span{data}.first(i % 64uz + 1uz),
+                                    buf,
+                                    0u,
+                                    false)};
+    v.insert(cend(v), cbegin(frame), cend(frame));
+  }
+  return v;
+}()};
+
+// Same stream in chunks of 64 bytes
+std::vector<std::span<uint8_t const>> const chunks{[] {
+  std::vector<std::span<uint8_t const>> v;
+  for (auto i{0uz}; i < size(stream); i += 64uz)
+    v.push_back(std::span{stream}.subspan(i, std::min(64uz, size(stream) - i)));
+  return v;
+}()};
+
+constexpr auto sum{[](uint32_t acc, std::span<uint8_t const> packet) {
+  return acc + packet[zusi::data_cnt_pos];
+}};
+
+void set_items(benchmark::State& state) {
+  state.SetItemsProcessed(state.iterations() * 1024);
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(size(stream)));
+}
+
+// Hand-written loop
+void loop(benchmark::State& state) {
+  for (auto _ : state) {
+    Decoder decoder;
+    uint32_t acc{};
+    std::span<uint8_t const> chunk{stream};
+    while (!empty(chunk))
+      if (auto const packet{decoder.receive(chunk, 0u)}; packet && *packet)
+        acc = sum(acc, **packet);
+    benchmark::DoNotOptimize(acc);
+  }
+  set_items(state);
+}
+
+void view(benchmark::State& state) {
+  for (auto _ : state) {
+    uint32_t acc{};
+    for (auto const& packet : stream | views::packets)
+      if (packet) acc = sum(acc, *packet);
+    benchmark::DoNotOptimize(acc);
+  }
+  set_items(state);
+}
+
+// Hand-written loop over chunks
+void loop_chunks(benchmark::State& state) {
+  for (auto _ : state) {
+    Decoder decoder;
+    uint32_t acc{};
+    for (auto chunk : chunks)
+      do
+        if (auto const packet{decoder.receive(chunk, 0u)}; packet && *packet)
+          acc = sum(acc, **packet);
+      while (!empty(chunk));
+    benchmark::DoNotOptimize(acc);
+  }
+  set_items(state);
+}
+
+void view_chunks(benchmark::State& state) {
+  for (auto _ : state) {
+    uint32_t acc{};
+    for (auto const& packet : chunks | views::packets)
+      if (packet) acc = sum(acc, *packet);
+    benchmark::DoNotOptimize(acc);
+  }
+  set_items(state);
+}
+
+// Hand-written loop byte by byte
+void loop_bytes(benchmark::State& state) {
+  for (auto _ : state) {
+    Decoder decoder;
+    uint32_t acc{};
+    for (auto const byte : stream)
+      if (auto const packet{decoder.receive({&byte, 1uz}, 0u)};
+          packet && *packet)
+        acc = sum(acc, **packet);
+    benchmark::DoNotOptimize(acc);
+  }
+  set_items(state);
+}
+
+void view_bytes(benchmark::State& state) {
+  auto const bytes{stream |
+                   std::views::transform([](uint8_t b) { return b; })};
+  for (auto _ : state) {
+    uint32_t acc{};
+    for (auto const& packet : bytes | views::packets)
+      if (packet) acc = sum(acc, *packet);
+    benchmark::DoNotOptimize(acc);
+  }
+  set_items(state);
+}
+
+} // namespace
+
+BENCHMARK(loop);
+BENCHMARK(view);
+BENCHMARK(loop_chunks);
+BENCHMARK(view_chunks);
+BENCHMARK(loop_bytes);
+BENCHMARK(view_bytes);
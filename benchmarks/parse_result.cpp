@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <random>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+// CvRead frames, every fourth one corrupt and every fourth one incomplete if
+// mixed
+std::vector<std::span<uint8_t const>> cvread_frames(bool mixed) {
+  static std::vector<std::array<uint8_t, header_size + cvread_size>> v(1024uz);
+  std::mt19937 gen{42u};
+  std::vector<std::span<uint8_t const>> spans;
+  for (auto i{0u}; i < size(v); ++i) {
+    auto& frame{v[i]};
+    frame = {0x00u, 0x00u, 0x00u, 0x01u, busy_flag, 0x01u};
+    uint32_2data(i, &frame[header_size + zusi::addr_pos]);
+    frame.back() =
+      zusi::crc8(std::span{frame}.subspan(header_size, cvread_size - 1uz));
+    std::span<uint8_t const> span{frame};
+    if (mixed) switch (gen() % 4u) {
+        case 0u: frame.back() ^= 0x01u; break;
+        case 1u: span = span.first(gen() % size(frame)); break;
+      }
+    spans.push_back(span);
+  }
+  return spans;
+}
+
+// Count packets with nested API
+void nested_frame2packet(benchmark::State& state) {
+  auto const frames{cvread_frames(state.range(0))};
+  for (auto _ : state) {
+    size_t count{};
+    for (auto const frame : frames) {
+      auto const packet{frame2packet(frame)};
+      count += packet && *packet;
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(frames)));
+}
+
+// Count packets with flat API
+void flat_frame2packet(benchmark::State& state) {
+  auto const frames{cvread_frames(state.range(0))};
+  for (auto _ : state) {
+    size_t count{};
+    for (auto const frame : frames) count += !!flat::frame2packet(frame);
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(frames)));
+}
+
+// Sum addresses with nested API
+void nested_get_address(benchmark::State& state) {
+  auto const frames{cvread_frames(false)};
+  for (auto _ : state) {
+    uint32_t sum{};
+    for (auto const frame : frames) {
+      auto const addr{get_address(frame.subspan(header_size))};
+      if (addr && *addr) sum += **addr;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(frames)));
+}
+
+// Sum addresses with flat API
+void flat_get_address(benchmark::State& state) {
+  auto const frames{cvread_frames(false)};
+  for (auto _ : state) {
+    uint32_t sum{};
+    for (auto const frame : frames)
+      if (auto const addr{flat::get_address(frame.subspan(header_size))})
+        sum += *addr;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(size(frames)));
+}
+
+} // namespace
+
+BENCHMARK(nested_frame2packet)->Arg(false)->Arg(true);
+BENCHMARK(flat_frame2packet)->Arg(false)->Arg(true);
+BENCHMARK(nested_get_address);
+BENCHMARK(flat_get_address);
@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include <zusi/crc8.hpp>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+// ZppWrite frames of maximum size as they appear during an update
+std::vector<std::vector<uint8_t>> zppwrite_frames(size_t n) {
+  std::mt19937 gen{42u};
+  std::uniform_int_distribution<uint32_t> byte{0u, 255u};
+  std::vector<std::vector<uint8_t>> frames;
+  for (auto i{0uz}; i < n; ++i) {
+    std::vector<uint8_t> frame{0x05u, 0xFFu};
+    for (auto j{0uz}; j < 4uz + 256uz; ++j)
+      frame.push_back(static_cast<uint8_t>(byte(gen)));
+    frame.push_back(zusi::crc8(frame));
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+void validate_loop(benchmark::State& state) {
+  auto const frames{zppwrite_frames(static_cast<size_t>(state.range(0)))};
+  std::vector<std::span<uint8_t const>> spans{cbegin(frames), cend(frames)};
+  for (auto _ : state) {
+    size_t count{};
+    for (auto const& span : spans) {
+      auto const valid{validate(span)};
+      count += valid && *valid;
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          static_cast<int64_t>(size(frames.front())));
+}
+
+void validate_batch(benchmark::State& state) {
+  auto const frames{zppwrite_frames(static_cast<size_t>(state.range(0)))};
+  std::vector<std::span<uint8_t const>> spans{cbegin(frames), cend(frames)};
+  std::vector<uint32_t> bitmap((size(spans) + 31uz) / 32uz);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ulf::susiv2::validate_batch(spans, bitmap));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          static_cast<int64_t>(size(frames.front())));
+}
+
+template<auto F>
+void crc8_batch_path(benchmark::State& state) {
+  auto const frames{zppwrite_frames(static_cast<size_t>(state.range(0)))};
+  std::vector<std::span<uint8_t const>> spans{cbegin(frames), cend(frames)};
+  std::vector<uint8_t> crcs(size(spans));
+  for (auto _ : state) {
+    F(spans, crcs);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          static_cast<int64_t>(size(frames.front())));
+}
+
+} // namespace
+
+BENCHMARK(validate_loop)->Arg(1024);
+BENCHMARK(validate_batch)->Arg(1024);
+BENCHMARK(crc8_batch_path<crc8_batch_scalar>)->Arg(1024);
+#if defined(ULF_SUSIV2_CRC8_SSSE3)
+BENCHMARK(crc8_batch_path<crc8_batch_ssse3>)->Arg(1024);
+#endif
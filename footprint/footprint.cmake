@@ -0,0 +1,117 @@
+# Footprint report
+#
+# Reads the size of every sizeof_* symbol (nm -S), the code size (nm -S, listed
+# as <function>.text) and the stack usage of every footprint_* function (.su
+# file written by -fstack-usage) of each configuration. The results are
+# printed as table and optionally written to a file. Values above their budget,
+# as well as unbounded stack usage, fail the script.
+#
+# Usage
+# cmake -DNM=nm -DCONFIGS=a,b -DOBJECT_a=a.o -DOBJECT_b=b.o -DBUDGET=budget.txt
+#       [-DOUTPUT=footprint.md] -P footprint.cmake
+#
+# Budget file
+# One line per limit, "<config> <item> <limit>". A config of * applies to
+# every configuration which has no limit of its own. Lines starting with #
+# are ignored.
+
+cmake_minimum_required(VERSION 3.25 FATAL_ERROR)
+
+string(REPLACE "," ";" CONFIGS "${CONFIGS}")
+set(ROWS)
+set(VIOLATIONS)
+
+foreach(config IN LISTS CONFIGS)
+  set(object ${OBJECT_${config}})
+
+  # Sizes of public types and code
+  execute_process(
+    COMMAND ${NM} -S ${object}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result)
+  if(result)
+    message(FATAL_ERROR "${NM} -S ${object} failed")
+  endif()
+  string(REPLACE "\n" ";" symbols "${symbols}")
+  foreach(line IN LISTS symbols)
+    if(line MATCHES
+       "^[0-9A-Fa-f]+ ([0-9A-Fa-f]+) [A-Za-z] _?(sizeof_[A-Za-z0-9_]+)$")
+      math(EXPR value "0x${CMAKE_MATCH_1}" OUTPUT_FORMAT DECIMAL)
+      list(APPEND ROWS ${CMAKE_MATCH_2})
+      set(VALUE_${config}_${CMAKE_MATCH_2} ${value})
+    elseif(line MATCHES
+           "^[0-9A-Fa-f]+ ([0-9A-Fa-f]+) [Tt] _?(footprint_[A-Za-z0-9_]+)$")
+      math(EXPR value "0x${CMAKE_MATCH_1}" OUTPUT_FORMAT DECIMAL)
+      list(APPEND ROWS ${CMAKE_MATCH_2}.text)
+      set(VALUE_${config}_${CMAKE_MATCH_2}.text ${value})
+    endif()
+  endforeach()
+
+  # Stack usage
+  string(REGEX REPLACE "\\.(o|obj)$" ".su" su ${object})
+  if(NOT EXISTS ${su})
+    message(FATAL_ERROR "${su} not found, compile with -fstack-usage")
+  endif()
+  file(STRINGS ${su} lines)
+  foreach(line IN LISTS lines)
+    if(line MATCHES "(footprint_[A-Za-z0-9_]+)\\([^\t]*\t([0-9]+)\t([a-z,]+)")
+      list(APPEND ROWS ${CMAKE_MATCH_1})
+      set(VALUE_${config}_${CMAKE_MATCH_1} ${CMAKE_MATCH_2})
+      if(CMAKE_MATCH_3 STREQUAL "dynamic")
+        set(VALUE_${config}_${CMAKE_MATCH_1} "${CMAKE_MATCH_2}+")
+        list(APPEND VIOLATIONS "${config} ${CMAKE_MATCH_1} unbounded")
+      endif()
+    endif()
+  endforeach()
+endforeach()
+list(REMOVE_DUPLICATES ROWS)
+
+# Budget
+file(STRINGS ${BUDGET} lines REGEX "^[^#]")
+foreach(line IN LISTS lines)
+  if(line MATCHES "^([^ \t]+)[ \t]+([^ \t]+)[ \t]+([0-9]+)")
+    set(config ${CMAKE_MATCH_1})
+    if(config STREQUAL "*")
+      set(config ALL)
+    endif()
+    set(LIMIT_${config}_${CMAKE_MATCH_2} ${CMAKE_MATCH_3})
+  endif()
+endforeach()
+
+# Table
+set(table "| Item |")
+set(rule "|:-----|")
+foreach(config IN LISTS CONFIGS)
+  string(APPEND table " ${config} |")
+  string(APPEND rule "-----:|")
+endforeach()
+string(APPEND table "\n${rule}\n")
+foreach(item IN LISTS ROWS)
+  string(APPEND table "| ${item} |")
+  foreach(config IN LISTS CONFIGS)
+    set(value "${VALUE_${config}_${item}}")
+    set(limit "${LIMIT_${config}_${item}}")
+    if(limit STREQUAL "")
+      set(limit "${LIMIT_ALL_${item}}")
+    endif()
+    if(value STREQUAL "")
+      string(APPEND table " - |")
+    elseif(NOT limit STREQUAL "" AND value GREATER limit)
+      string(APPEND table " ${value} (> ${limit}) |")
+      list(APPEND VIOLATIONS "${config} ${item} ${value} > ${limit}")
+    else()
+      string(APPEND table " ${value} |")
+    endif()
+  endforeach()
+  string(APPEND table "\n")
+endforeach()
+
+message("${table}")
+if(DEFINED OUTPUT)
+  file(WRITE ${OUTPUT} "${table}")
+endif()
+
+if(VIOLATIONS)
+  list(JOIN VIOLATIONS "\n  " violations)
+  message(FATAL_ERROR "Footprint exceeds budget\n  ${violations}")
+endif()
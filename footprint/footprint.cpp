@@ -0,0 +1,163 @@
+// Footprint of a configuration
+//
+// Every sizeof_* array has the size of a public type, every footprint_*
+// function wraps one call of the hot path and is flattened so that its code
+// and stack frame include everything it calls. Neither is meant to be
+// linked, the footprint script reads symbol sizes with nm and stack usage from
+// the .su files written by -fstack-usage.
+//
+// ULF_SUSIV2_FOOTPRINT_ZPP selects the command subset, 0 leaves out
+// everything only needed for ZPP updates.
+
+#include "ulf/susiv2.hpp"
+
+#ifndef ULF_SUSIV2_FOOTPRINT_ZPP
+#  define ULF_SUSIV2_FOOTPRINT_ZPP 1
+#endif
+
+using namespace ulf::susiv2;
+
+#define ULF_SUSIV2_SIZEOF(NAME, ...)                                           \
+  extern "C" [[gnu::used]] char const sizeof_##NAME[sizeof(__VA_ARGS__)] {}
+
+// Types
+ULF_SUSIV2_SIZEOF(Decoder, Decoder);
+ULF_SUSIV2_SIZEOF(ResponseDecoder, ResponseDecoder);
+ULF_SUSIV2_SIZEOF(Response, Response);
+ULF_SUSIV2_SIZEOF(SequencedResponse, SequencedResponse);
+ULF_SUSIV2_SIZEOF(MultiFrame, MultiFrame);
+ULF_SUSIV2_SIZEOF(MultiResponse, MultiResponse);
+ULF_SUSIV2_SIZEOF(FrameTemplate, FrameTemplate);
+ULF_SUSIV2_SIZEOF(Window, Window);
+
+// Return types
+ULF_SUSIV2_SIZEOF(frame2packet_result,
+                  decltype(frame2packet(std::span<uint8_t const>{})));
+ULF_SUSIV2_SIZEOF(validate_result,
+                  decltype(validate(std::span<uint8_t const>{})));
+ULF_SUSIV2_SIZEOF(get_address_result,
+                  decltype(get_address(std::span<uint8_t const>{})));
+ULF_SUSIV2_SIZEOF(get_data_result,
+                  decltype(get_data(std::span<uint8_t const>{})));
+ULF_SUSIV2_SIZEOF(flat_frame2packet_result,
+                  decltype(flat::frame2packet(std::span<uint8_t const>{})));
+ULF_SUSIV2_SIZEOF(flat_get_address_result,
+                  decltype(flat::get_address(std::span<uint8_t const>{})));
+
+extern "C" {
+
+// Receiver
+[[gnu::flatten]]
+size_t footprint_frame2packet(uint8_t const* frame, size_t n) {
+  auto const packet{frame2packet({frame, n})};
+  return packet && *packet ? size(**packet) : 0uz;
+}
+
+[[gnu::flatten]]
+bool footprint_validate(uint8_t const* frame, size_t n) {
+  auto const valid{validate({frame, n})};
+  return valid && *valid && **valid;
+}
+
+[[gnu::flatten]]
+uint32_t footprint_get_address(uint8_t const* frame, size_t n) {
+  auto const addr{get_address({frame, n})};
+  return addr && *addr ? **addr : 0u;
+}
+
+[[gnu::flatten]]
+size_t footprint_get_data(uint8_t const* frame, size_t n, uint8_t* out) {
+  auto const data{get_data({frame, n})};
+  if (!data || !*data) return 0uz;
+  std::ranges::copy(**data, out);
+  return size(**data);
+}
+
+[[gnu::flatten]]
+uint8_t footprint_get_checksum(uint8_t const* frame, size_t n) {
+  auto const crc{get_checksum({frame, n})};
+  return crc && *crc ? **crc : 0u;
+}
+
+// Receiver, flat API
+[[gnu::flatten]]
+size_t footprint_flat_frame2packet(uint8_t const* frame, size_t n) {
+  auto const packet{flat::frame2packet({frame, n})};
+  return packet ? size(*packet) : 0uz;
+}
+
+[[gnu::flatten]]
+bool footprint_flat_validate(uint8_t const* frame, size_t n) {
+  return flat::validate({frame, n}) == Status::Ok;
+}
+
+[[gnu::flatten]]
+uint32_t footprint_flat_get_address(uint8_t const* frame, size_t n) {
+  auto const addr{flat::get_address({frame, n})};
+  return addr ? *addr : 0u;
+}
+
+[[gnu::flatten]]
+uint8_t footprint_flat_get_checksum(uint8_t const* frame, size_t n) {
+  auto const crc{flat::get_checksum({frame, n})};
+  return crc ? *crc : 0u;
+}
+
+[[gnu::flatten]]
+size_t footprint_decoder_receive(Decoder* decoder,
+                                 uint8_t const* chunk,
+                                 size_t n,
+                                 uint32_t now) {
+  auto const packet{decoder->receive({chunk, n}, now)};
+  return packet && *packet ? size(**packet) : 0uz;
+}
+
+[[gnu::flatten]]
+size_t footprint_feedback2response(zusi::Feedback const* fb, uint8_t* out) {
+  auto const resp{feedback2response(*fb)};
+  std::ranges::copy(resp, out);
+  return size(resp);
+}
+
+[[gnu::flatten]]
+bool footprint_detect(uint8_t const* bytes, size_t n) {
+  return detect({bytes, n}) == Confidence::High;
+}
+
+// Transmitter
+[[gnu::flatten]]
+bool footprint_response2feedback(uint8_t const* resp,
+                                 size_t n,
+                                 uint32_t answer_length) {
+  return response2feedback({resp, n}, answer_length).has_value();
+}
+
+[[gnu::flatten]]
+size_t footprint_response_decoder_receive(ResponseDecoder* decoder,
+                                          uint8_t const* chunk,
+                                          size_t n) {
+  auto const data{decoder->receive({chunk, n})};
+  return data && *data ? size(**data) : 0uz;
+}
+
+#if ULF_SUSIV2_FOOTPRINT_ZPP
+[[gnu::flatten]]
+size_t footprint_frame2packet_compressed(
+  uint8_t const* frame,
+  size_t n,
+  std::array<uint8_t, max_zppwrite_size>* buffer) {
+  auto const packet{frame2packet({frame, n}, *buffer)};
+  return packet && *packet ? size(**packet) : 0uz;
+}
+
+[[gnu::flatten]]
+size_t footprint_zppwrite2frame(
+  uint32_t addr,
+  uint8_t const* data,
+  size_t n,
+  std::array<uint8_t, header_size + max_zppwrite_size>* out) {
+  return size(zppwrite2frame(addr, {data, n}, *out));
+}
+#endif
+
+} // extern "C"
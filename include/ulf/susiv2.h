@@ -0,0 +1,149 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+/** ULF_SUSIV2 C API
+ *
+ * Batch entry points for host tooling. Every call processes an array of
+ * frames, packets or responses located in caller-owned contiguous buffers,
+ * described by offset tables. Nothing is allocated.
+ *
+ * \file   ulf/susiv2.h
+ * \author Vincent Hamp
+ * \date   19/10/2026 */
+
+#ifndef ULF_SUSIV2_H
+#define ULF_SUSIV2_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(ULF_SUSIV2_EXPORTS)
+#    define ULF_SUSIV2_API __declspec(dllexport)
+#  else
+#    define ULF_SUSIV2_API __declspec(dllimport)
+#  endif
+#else
+#  define ULF_SUSIV2_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Version of this ABI, changes whenever a signature does */
+#define ULF_SUSIV2_ABI_VERSION 1u
+
+/** Status of a single entry
+ *
+ * The values are the same on every platform. */
+#define ULF_SUSIV2_STATUS_OK 0              /**< Entry is valid */
+#define ULF_SUSIV2_STATUS_INCOMPLETE 1      /**< More bytes needed */
+#define ULF_SUSIV2_STATUS_CORRUPT 2         /**< Checksum mismatch */
+#define ULF_SUSIV2_STATUS_UNKNOWN_COMMAND 3 /**< Unknown command */
+#define ULF_SUSIV2_STATUS_BAD_HEADER 4      /**< Unsupported flags */
+#define ULF_SUSIV2_STATUS_OUT_OF_BOUNDS 5   /**< Slice outside of buffer */
+
+/** Location of an entry inside a buffer
+ *
+ * Offsets are 32 bit, slices ending beyond 4 GiB are out of bounds and output
+ * buffers are only filled up to 4 GiB. */
+typedef struct ulf_susiv2_slice {
+  uint32_t offset;
+  uint32_t size;
+} ulf_susiv2_slice;
+
+/** Get ABI version of the library
+ *
+ * \return ULF_SUSIV2_ABI_VERSION the library was built with */
+ULF_SUSIV2_API uint32_t ulf_susiv2_abi_version(void);
+
+/** Convert frames to ZUSI packets
+ *
+ * Packets are not copied, their slices point into buf.
+ *
+ * \param  buf       Buffer containing frames
+ * \param  buf_size  Size of buf
+ * \param  frames    Slices of count frames
+ * \param  count     Number of frames
+ * \param  packets   Slices of count packets (size 0 unless status is OK)
+ * \param  status    Status of count frames
+ * \return Number of frames successfully converted */
+ULF_SUSIV2_API size_t ulf_susiv2_decode(uint8_t const* buf,
+                                        size_t buf_size,
+                                        ulf_susiv2_slice const* frames,
+                                        size_t count,
+                                        ulf_susiv2_slice* packets,
+                                        int32_t* status);
+
+/** Validate frames
+ *
+ * Frames are checked like ulf_susiv2_decode does, only the checksums are
+ * verified several frames at a time.
+ *
+ * \param  buf       Buffer containing frames
+ * \param  buf_size  Size of buf
+ * \param  frames    Slices of count frames
+ * \param  count     Number of frames
+ * \param  valid     Bitmap with one bit per frame (LSB first), set if valid,
+ *                   must hold at least (count + 31) / 32 words
+ * \param  status    Status of count frames (may be NULL)
+ * \return Number of valid frames */
+ULF_SUSIV2_API size_t ulf_susiv2_validate(uint8_t const* buf,
+                                          size_t buf_size,
+                                          ulf_susiv2_slice const* frames,
+                                          size_t count,
+                                          uint32_t* valid,
+                                          int32_t* status);
+
+/** Convert ZUSI packets to frames
+ *
+ * \param  buf             Buffer containing packets
+ * \param  buf_size        Size of buf
+ * \param  packets         Slices of count packets
+ * \param  answer_lengths  Expected answer lengths of count packets
+ * \param  flags           Flags of count packets (e.g. busy)
+ * \param  count           Number of packets
+ * \param  out             Buffer for frames
+ * \param  out_size        Size of out
+ * \param  frames          Slices of count frames
+ * \return Number of packets converted, less than count if out is full or a
+ *         slice is out of bounds */
+ULF_SUSIV2_API size_t ulf_susiv2_encode(uint8_t const* buf,
+                                        size_t buf_size,
+                                        ulf_susiv2_slice const* packets,
+                                        uint32_t const* answer_lengths,
+                                        uint8_t const* flags,
+                                        size_t count,
+                                        uint8_t* out,
+                                        size_t out_size,
+                                        ulf_susiv2_slice* frames);
+
+/** Convert ZUSI feedback to responses
+ *
+ * \param  buf       Buffer containing feedback data
+ * \param  buf_size  Size of buf
+ * \param  data      Slices of count feedback data
+ * \param  status    Status of count feedbacks, nak unless
+ *                   ULF_SUSIV2_STATUS_OK
+ * \param  count     Number of feedbacks
+ * \param  out       Buffer for responses
+ * \param  out_size  Size of out
+ * \param  responses Slices of count responses
+ * \return Number of feedbacks converted, less than count if out is full or a
+ *         slice is out of bounds or too large */
+ULF_SUSIV2_API size_t ulf_susiv2_responses(uint8_t const* buf,
+                                           size_t buf_size,
+                                           ulf_susiv2_slice const* data,
+                                           int32_t const* status,
+                                           size_t count,
+                                           uint8_t* out,
+                                           size_t out_size,
+                                           ulf_susiv2_slice* responses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULF_SUSIV2_H */
@@ -11,8 +11,22 @@
 #pragma once
 
 #include "susiv2/ack.hpp"
+#include "susiv2/capture.hpp"
+#include "susiv2/compression.hpp"
+#include "susiv2/crc8.hpp"
+#include "susiv2/decoder.hpp"
+#include "susiv2/detect.hpp"
 #include "susiv2/feedback2response.hpp"
 #include "susiv2/frame2packet.hpp"
+#include "susiv2/frame_template.hpp"
+#include "susiv2/header.hpp"
+#include "susiv2/multi.hpp"
 #include "susiv2/nak.hpp"
+#include "susiv2/packet_view.hpp"
+#include "susiv2/packets_view.hpp"
+#include "susiv2/parse_result.hpp"
+#include "susiv2/pipeline.hpp"
+#include "susiv2/response2feedback.hpp"
+#include "susiv2/timing_model.hpp"
 #include "susiv2/utility.hpp"
 #include "susiv2/validate.hpp"
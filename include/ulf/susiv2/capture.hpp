@@ -0,0 +1,283 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Binary capture of frame and response traffic
+///
+/// \file   ulf/susiv2/capture.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <utility>
+#include "frame2packet.hpp"
+
+namespace ulf::susiv2 {
+
+/// Direction of captured traffic
+enum class Direction : uint8_t {
+  Frame = 0u,    ///< Transmitter -> receiver
+  Response = 1u, ///< Receiver -> transmitter
+};
+
+/// Capture layout
+///
+/// A capture starts with an 8 byte header (magic, version, 3 reserved bytes)
+/// followed by any number of records. Each record consists of an 8 byte
+/// timestamp in µs, a direction byte, a 2 byte length and the raw data. All
+/// multi-byte fields are big-endian, the same as the SUSIV2 header.
+inline constexpr std::array<uint8_t, 4uz> capture_magic{'S', 'V', '2', 'C'};
+inline constexpr uint8_t capture_version{1u};
+inline constexpr size_t capture_header_size{8uz};
+inline constexpr size_t capture_record_header_size{11uz};
+
+/// Size of a record including its header
+///
+/// \param  data_size Size of the captured data
+/// \return Size of the record
+constexpr size_t capture_record_size(size_t data_size) {
+  return capture_record_header_size + data_size;
+}
+
+/// Write capture header
+///
+/// \param  out   Buffer of at least capture_header_size bytes
+/// \return Remainder of out past the header
+constexpr std::span<uint8_t> write_capture_header(std::span<uint8_t> out) {
+  std::ranges::copy(capture_magic, begin(out));
+  out[4uz] = capture_version;
+  out[5uz] = out[6uz] = out[7uz] = 0u;
+  return out.subspan(capture_header_size);
+}
+
+/// Captured record
+struct CaptureRecord {
+  uint64_t timestamp{}; ///< Monotonic timestamp [µs]
+  Direction direction{};
+  std::span<uint8_t const> data{};
+};
+
+/// Single-producer single-consumer capture writer
+///
+/// Records are pushed from the communication path (e.g. an interrupt or the
+/// receive thread) and drained from another context which writes them to a
+/// file. Neither side ever blocks, a record which doesn't fit is dropped and
+/// counted.
+///
+/// \tparam Size  Size of the ring buffer in bytes (power of 2)
+template<size_t Size>
+requires(std::has_single_bit(Size) && Size > capture_record_header_size)
+class CaptureWriter {
+public:
+  /// Push record (producer)
+  ///
+  /// \param  dir   Direction
+  /// \param  ts    Monotonic timestamp [µs]
+  /// \param  data  Raw frame or response
+  /// \retval true  Record pushed
+  /// \retval false Not enough space, record dropped
+  bool push(Direction dir, uint64_t ts, std::span<uint8_t const> data) {
+    auto const head{_head.load(std::memory_order_relaxed)};
+    auto const tail{_tail.load(std::memory_order_acquire)};
+    auto const n{capture_record_size(size(data))};
+    if (size(data) > UINT16_MAX || Size - (head - tail) < n) {
+      _dropped.fetch_add(1u, std::memory_order_relaxed);
+      return false;
+    }
+    auto i{head};
+    for (auto s{56}; s >= 0; s -= 8) put(i++, static_cast<uint8_t>(ts >> s));
+    put(i++, std::to_underlying(dir));
+    put(i++, static_cast<uint8_t>(size(data) >> 8u));
+    put(i++, static_cast<uint8_t>(size(data)));
+    for (auto const b : data) put(i++, b);
+    _head.store(head + n, std::memory_order_release);
+    return true;
+  }
+
+  /// Drain pending bytes (consumer)
+  ///
+  /// \tparam F     Callable taking a std::span<uint8_t const>
+  /// \param  f     Invoked with up to two contiguous chunks
+  /// \return Number of bytes drained
+  template<std::invocable<std::span<uint8_t const>> F>
+  size_t drain(F&& f) {
+    auto const tail{_tail.load(std::memory_order_relaxed)};
+    auto const head{_head.load(std::memory_order_acquire)};
+    auto const n{head - tail};
+    if (!n) return 0uz;
+    auto const first{tail % Size};
+    auto const len{std::min(n, Size - first)};
+    std::invoke(f, std::span<uint8_t const>{&_buf[first], len});
+    if (len < n) std::invoke(f, std::span<uint8_t const>{&_buf[0uz], n - len});
+    _tail.store(head, std::memory_order_release);
+    return n;
+  }
+
+  /// Number of dropped records
+  size_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+  void put(size_t i, uint8_t b) { _buf[i % Size] = b; }
+
+  std::array<uint8_t, Size> _buf{};
+  alignas(64) std::atomic<size_t> _head{};
+  alignas(64) std::atomic<size_t> _tail{};
+  std::atomic<size_t> _dropped{};
+};
+
+/// Zero-copy view on a capture
+///
+/// The view doesn't own any data. Large captures are best memory-mapped by
+/// the caller and passed as a whole, records then refer directly into the
+/// mapping. A truncated trailing record (e.g. capture aborted) ends the
+/// iteration.
+class CaptureView {
+public:
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = CaptureRecord;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr iterator() = default;
+    constexpr explicit iterator(std::span<uint8_t const> rest) : _rest{rest} {
+      parse();
+    }
+
+    constexpr CaptureRecord const& operator*() const { return _rec; }
+    constexpr CaptureRecord const* operator->() const { return &_rec; }
+
+    constexpr iterator& operator++() {
+      _rest = _rest.subspan(capture_record_size(size(_rec.data)));
+      parse();
+      return *this;
+    }
+
+    constexpr iterator operator++(int) {
+      auto tmp{*this};
+      ++*this;
+      return tmp;
+    }
+
+    constexpr bool operator==(iterator const& rhs) const {
+      return data(_rest) == data(rhs._rest) && size(_rest) == size(rhs._rest);
+    }
+
+  private:
+    constexpr void parse() {
+      if (size(_rest) < capture_record_header_size) return reset();
+      uint64_t ts{};
+      for (auto i{0uz}; i < 8uz; ++i) ts = ts << 8u | _rest[i];
+      size_t const len{static_cast<size_t>(_rest[9uz] << 8u | _rest[10uz])};
+      if (size(_rest) < capture_record_size(len)) return reset();
+      _rec = {.timestamp = ts,
+              .direction = static_cast<Direction>(_rest[8uz]),
+              .data = _rest.subspan(capture_record_header_size, len)};
+    }
+
+    constexpr void reset() {
+      _rest = {};
+      _rec = {};
+    }
+
+    std::span<uint8_t const> _rest{};
+    CaptureRecord _rec{};
+  };
+
+  constexpr CaptureView() = default;
+  constexpr explicit CaptureView(std::span<uint8_t const> records)
+    : _records{records} {}
+
+  constexpr iterator begin() const { return iterator{_records}; }
+  constexpr iterator end() const { return {}; }
+
+private:
+  std::span<uint8_t const> _records{};
+};
+
+/// Open capture
+///
+/// \param  capture         Complete capture including header
+/// \retval CaptureView     View on records
+/// \retval std::errc       Missing header, wrong magic or unsupported version
+constexpr std::expected<CaptureView, std::errc>
+read_capture(std::span<uint8_t const> capture) {
+  if (size(capture) < capture_header_size ||
+      !std::ranges::equal(capture.first(size(capture_magic)), capture_magic) ||
+      capture[4uz] != capture_version)
+    return std::unexpected{std::errc::protocol_error};
+  return CaptureView{capture.subspan(capture_header_size)};
+}
+
+/// Outcome of a replay
+struct ReplayStats {
+  size_t frames{};     ///< Frame records
+  size_t responses{};  ///< Response records
+  size_t packets{};    ///< Frames which contained a valid packet
+  size_t incomplete{}; ///< Frames which were incomplete
+  size_t corrupt{};    ///< Frames which were corrupt
+  uint64_t first{};    ///< Timestamp of first record [µs]
+  uint64_t last{};     ///< Timestamp of last record [µs]
+  uint64_t rtt_min{UINT64_MAX}; ///< Shortest frame to response time [µs]
+  uint64_t rtt_max{};           ///< Longest frame to response time [µs]
+  uint64_t rtt_sum{};           ///< Sum of all frame to response times [µs]
+  size_t rtt_count{};           ///< Number of frame to response pairs
+};
+
+/// Replay capture through frame2packet
+///
+/// \tparam F     Callable taking a CaptureRecord and the frame2packet result
+/// \param  view  Capture to replay
+/// \param  f     Invoked for every frame record
+/// \return Replay statistics
+template<typename F>
+constexpr ReplayStats replay(CaptureView view, F&& f) {
+  ReplayStats stats{};
+  std::optional<uint64_t> pending{};
+  bool first{true};
+  for (auto const& rec : view) {
+    if (first) stats.first = rec.timestamp, first = false;
+    stats.last = rec.timestamp;
+    if (rec.direction == Direction::Frame) {
+      ++stats.frames;
+      pending = rec.timestamp;
+      auto const packet{frame2packet(rec.data)};
+      if (!packet) ++stats.corrupt;
+      else if (!*packet) ++stats.incomplete;
+      else ++stats.packets;
+      std::invoke(f, rec, packet);
+    } else {
+      ++stats.responses;
+      if (!pending) continue;
+      auto const rtt{rec.timestamp - *pending};
+      stats.rtt_min = std::min(stats.rtt_min, rtt);
+      stats.rtt_max = std::max(stats.rtt_max, rtt);
+      stats.rtt_sum += rtt;
+      ++stats.rtt_count;
+      pending.reset();
+    }
+  }
+  return stats;
+}
+
+/// Replay capture through frame2packet
+///
+/// \param  view  Capture to replay
+/// \return Replay statistics
+constexpr ReplayStats replay(CaptureView view) {
+  return replay(view, [](auto&&...) {});
+}
+
+} // namespace ulf::susiv2
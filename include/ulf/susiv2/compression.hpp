@@ -0,0 +1,192 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Compressed ZppWrite frames
+///
+/// \file   ulf/susiv2/compression.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <utility>
+#include <zusi/command.hpp>
+#include "crc8.hpp"
+#include "frame2packet.hpp"
+#include "header.hpp"
+#include "utility.hpp"
+
+namespace ulf::susiv2 {
+
+/// Compressed ZppWrite packet
+///
+/// Frames with the compressed_flag set carry a ZppWrite packet whose data is
+/// compressed with PackBits (run length encoding). The packet looks like a
+/// ZppWrite packet with an additional length byte in front of the data.
+/// | cmd | cnt | addr (4) | clen | compressed data (clen + 1) | crc8 |
+/// cnt is the count of the decompressed data, the CRC8 covers the compressed
+/// packet.
+inline constexpr size_t compressed_len_pos{zusi::data_pos};
+inline constexpr size_t compressed_data_pos{zusi::data_pos + 1uz};
+inline constexpr size_t compressed_zppwrite_size(uint8_t clen) {
+  return 7uz + clen + 1uz + 1uz;
+}
+
+/// Size of a packet buffer able to hold any decompressed ZppWrite packet
+inline constexpr size_t max_zppwrite_size{zppwrite_size(0xFFu)};
+
+/// Compress data (PackBits)
+///
+/// \param  in            Data to compress
+/// \param  out           Compressed data
+/// \retval size_t        Size of compressed data
+/// \retval std::nullopt  out is too small
+constexpr std::optional<size_t> compress(std::span<uint8_t const> in,
+                                         std::span<uint8_t> out) {
+  size_t i{}, o{};
+  while (i < size(in)) {
+    // Repeated run
+    size_t run{1uz};
+    while (i + run < size(in) && run < 128uz && in[i + run] == in[i]) ++run;
+    if (run >= 3uz) {
+      if (o + 2uz > size(out)) return std::nullopt;
+      out[o++] = static_cast<uint8_t>(257uz - run);
+      out[o++] = in[i];
+      i += run;
+      continue;
+    }
+
+    // Literal run, ends where the next repeated run starts
+    auto const first{i};
+    while (i < size(in) && i - first < 128uz &&
+           !(i + 2uz < size(in) && in[i] == in[i + 1uz] &&
+             in[i] == in[i + 2uz]))
+      ++i;
+    auto const n{i - first};
+    if (o + 1uz + n > size(out)) return std::nullopt;
+    out[o++] = static_cast<uint8_t>(n - 1uz);
+    std::ranges::copy(in.subspan(first, n), begin(out.subspan(o)));
+    o += n;
+  }
+  return o;
+}
+
+/// Decompress data (PackBits)
+///
+/// \param  in        Compressed data
+/// \param  out       Decompressed data
+/// \retval size_t    Size of decompressed data
+/// \retval std::errc Compressed data is corrupt or out is too small
+constexpr std::expected<size_t, std::errc>
+decompress(std::span<uint8_t const> in, std::span<uint8_t> out) {
+  size_t i{}, o{};
+  while (i < size(in)) {
+    auto const ctrl{in[i++]};
+    // Literal run
+    if (ctrl < 128u) {
+      size_t const n{ctrl + 1uz};
+      if (i + n > size(in) || o + n > size(out))
+        return std::unexpected{std::errc::protocol_error};
+      std::ranges::copy(in.subspan(i, n), begin(out.subspan(o)));
+      i += n;
+      o += n;
+    }
+    // Repeated run
+    else if (ctrl > 128u) {
+      size_t const n{257uz - ctrl};
+      if (i >= size(in) || o + n > size(out))
+        return std::unexpected{std::errc::protocol_error};
+      std::ranges::fill(out.subspan(o, n), in[i++]);
+      o += n;
+    }
+  }
+  return o;
+}
+
+/// Convert compressed frame to ZUSI packet
+///
+/// Frames without the compressed_flag are passed on to frame2packet.
+///
+/// \param[in]  frame         SUSIV2 frame to be converted
+/// \param[out] buffer        Packet buffer for decompressed ZppWrite packet
+/// \retval     std::span     View on packet (either frame or buffer)
+/// \retval     std::nullopt  Frame incomplete
+/// \retval     std::errc     Frame corrupt
+constexpr std::expected<std::optional<std::span<uint8_t const>>, std::errc>
+frame2packet(std::span<uint8_t const> frame,
+             std::span<uint8_t, max_zppwrite_size> buffer) {
+  auto const flags{get_flags(frame)};
+  if (!flags || !(*flags & compressed_flag)) return frame2packet(frame);
+
+  auto const packet{frame.subspan(header_size)};
+  if (size(packet) <= compressed_len_pos) return std::nullopt;
+  if (packet[zusi::cmd_pos] != std::to_underlying(zusi::Command::ZppWrite))
+    return std::unexpected{std::errc::protocol_error};
+  auto const packet_size{
+    compressed_zppwrite_size(packet[compressed_len_pos])};
+  if (size(packet) < packet_size) return std::nullopt;
+  if (crc8_update(0u, packet.first(packet_size)))
+    return std::unexpected{std::errc::protocol_error};
+
+  // Decompress into buffer and turn it into a regular ZppWrite packet
+  auto const cnt{packet[zusi::data_cnt_pos]};
+  std::ranges::copy(packet.first(zusi::data_pos), begin(buffer));
+  auto const n{decompress(
+    packet.subspan(compressed_data_pos, packet[compressed_len_pos] + 1uz),
+    std::span{buffer}.subspan(zusi::data_pos, cnt + 1uz))};
+  if (!n || *n != cnt + 1uz) return std::unexpected{std::errc::protocol_error};
+  auto const crc_pos{zppwrite_size(cnt) - 1uz};
+  buffer[crc_pos] = crc8_update(0u, std::span{buffer}.first(crc_pos));
+  return std::span<uint8_t const>{buffer}.first(zppwrite_size(cnt));
+}
+
+/// Convert ZppWrite data to frame, compressed if smaller
+///
+/// \param  addr          Address
+/// \param  data          Data (1-256 bytes)
+/// \param  out           Buffer for the frame
+/// \param  answer_length Length of the expected answer
+/// \param  allow         Allow compression (receiver supports it)
+/// \return View on frame
+constexpr std::span<uint8_t const>
+zppwrite2frame(uint32_t addr,
+               std::span<uint8_t const> data,
+               std::span<uint8_t, header_size + max_zppwrite_size> out,
+               uint32_t answer_length = 0u,
+               bool allow = true) {
+  uint32_2data(answer_length, &out[answer_length_pos]);
+  out[flags_pos] = busy_flag;
+  auto const packet{std::span{out}.subspan(header_size)};
+  packet[zusi::cmd_pos] = std::to_underlying(zusi::Command::ZppWrite);
+  packet[zusi::data_cnt_pos] = static_cast<uint8_t>(size(data) - 1uz);
+  uint32_2data(addr, &packet[zusi::addr_pos]);
+
+  // The compressed packet carries an additional length byte, so compressed
+  // data must be at least 2 bytes smaller than raw data for the frame to get
+  // smaller. This also limits it to 254 bytes.
+  auto const n{
+    allow && size(data) > 2uz
+      ? compress(data, packet.subspan(compressed_data_pos, size(data) - 2uz))
+      : std::nullopt};
+  size_t packet_size{};
+  if (n) {
+    out[flags_pos] |= compressed_flag;
+    packet[compressed_len_pos] = static_cast<uint8_t>(*n - 1uz);
+    packet_size = compressed_zppwrite_size(packet[compressed_len_pos]);
+  } else {
+    std::ranges::copy(data, begin(packet.subspan(zusi::data_pos)));
+    packet_size = zppwrite_size(packet[zusi::data_cnt_pos]);
+  }
+  packet[packet_size - 1uz] = crc8_update(0u, packet.first(packet_size - 1uz));
+  return std::span<uint8_t const>{out}.first(header_size + packet_size);
+}
+
+} // namespace ulf::susiv2
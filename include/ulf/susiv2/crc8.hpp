@@ -0,0 +1,172 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Table driven CRC8
+///
+/// \file   ulf/susiv2/crc8.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+
+// SSSE3 path is compiled with a target attribute and selected at runtime
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+  (defined(__GNUC__) || defined(__clang__))
+#  define ULF_SUSIV2_CRC8_SSSE3
+#  include <immintrin.h>
+#endif
+
+namespace ulf::susiv2 {
+
+/// CRC8 lookup table (same polynomial as zusi::crc8)
+inline constexpr auto crc8_table{[] {
+  std::array<uint8_t, 256uz> table{};
+  for (auto i{0uz}; i < size(table); ++i) {
+    auto crc{static_cast<uint8_t>(i)};
+    for (auto j{0uz}; j < 8uz; ++j)
+      crc = crc & 0x01u ? static_cast<uint8_t>((crc >> 1u) ^ 0x8Cu)
+                        : static_cast<uint8_t>(crc >> 1u);
+    table[i] = crc;
+  }
+  return table;
+}()};
+
+#if defined(ULF_SUSIV2_CRC8_SSSE3)
+/// CRC8 lookup tables for low and high nibble
+///
+/// The CRC is linear, so the table entry of a byte is the XOR of the entries
+/// of its two nibbles. 16 entries fit into a SSE register and can be looked up
+/// with a shuffle.
+inline constexpr auto crc8_table_lo{[] {
+  std::array<uint8_t, 16uz> table{};
+  for (auto i{0uz}; i < size(table); ++i) table[i] = crc8_table[i];
+  return table;
+}()};
+inline constexpr auto crc8_table_hi{[] {
+  std::array<uint8_t, 16uz> table{};
+  for (auto i{0uz}; i < size(table); ++i) table[i] = crc8_table[i << 4uz];
+  return table;
+}()};
+#endif
+
+/// Continue CRC8 over bytes
+///
+/// \param  crc   CRC8 of preceding bytes
+/// \param  bytes Bytes
+/// \return CRC8
+constexpr uint8_t crc8_update(uint8_t crc, std::span<uint8_t const> bytes) {
+  for (auto const b : bytes) crc = crc8_table[crc ^ b];
+  return crc;
+}
+
+/// Calculate CRC8 of many buffers at once (portable)
+///
+/// Independent buffers are interleaved so that the table lookups of different
+/// buffers overlap instead of waiting on each other.
+///
+/// \param  in  Buffers
+/// \param  out CRC8 of each buffer, must be at least as large as in
+constexpr void crc8_batch_scalar(std::span<std::span<uint8_t const> const> in,
+                                 std::span<uint8_t> out) {
+  auto i{0uz};
+
+  for (; i + 4uz <= size(in); i += 4uz) {
+    auto const lanes{in.subspan(i, 4uz)};
+    auto const len{std::ranges::min(lanes, {}, [](auto s) {
+                     return size(s);
+                   }).size()};
+    uint8_t c0{}, c1{}, c2{}, c3{};
+    for (auto j{0uz}; j < len; ++j) {
+      c0 = crc8_table[c0 ^ lanes[0uz][j]];
+      c1 = crc8_table[c1 ^ lanes[1uz][j]];
+      c2 = crc8_table[c2 ^ lanes[2uz][j]];
+      c3 = crc8_table[c3 ^ lanes[3uz][j]];
+    }
+    out[i + 0uz] = crc8_update(c0, lanes[0uz].subspan(len));
+    out[i + 1uz] = crc8_update(c1, lanes[1uz].subspan(len));
+    out[i + 2uz] = crc8_update(c2, lanes[2uz].subspan(len));
+    out[i + 3uz] = crc8_update(c3, lanes[3uz].subspan(len));
+  }
+
+  for (; i < size(in); ++i) out[i] = crc8_update(0u, in[i]);
+}
+
+#if defined(ULF_SUSIV2_CRC8_SSSE3)
+/// Calculate CRC8 of many buffers at once (SSSE3)
+///
+/// 16 buffers are processed per vector using nibble lookups, the remaining
+/// ones by crc8_batch_scalar. Must only be called if the CPU supports SSSE3.
+///
+/// \param  in  Buffers
+/// \param  out CRC8 of each buffer, must be at least as large as in
+[[gnu::target("ssse3")]] inline void
+crc8_batch_ssse3(std::span<std::span<uint8_t const> const> in,
+                 std::span<uint8_t> out) {
+  auto i{0uz};
+  auto const lo{
+    _mm_loadu_si128(reinterpret_cast<__m128i const*>(data(crc8_table_lo)))};
+  auto const hi{
+    _mm_loadu_si128(reinterpret_cast<__m128i const*>(data(crc8_table_hi)))};
+  auto const mask{_mm_set1_epi8(0x0F)};
+  for (; i + 16uz <= size(in); i += 16uz) {
+    auto const lanes{in.subspan(i, 16uz)};
+    auto const len{std::ranges::min(lanes, {}, [](auto s) {
+                     return size(s);
+                   }).size() &
+                   ~15uz};
+    auto crcs{_mm_setzero_si128()};
+    for (auto j{0uz}; j < len; j += 16uz) {
+      // Load 16 bytes of each lane and transpose them, afterwards each
+      // register holds the same position of all lanes
+      __m128i rows[16uz];
+      for (auto k{0uz}; k < 16uz; ++k)
+        rows[k] =
+          _mm_loadu_si128(reinterpret_cast<__m128i const*>(&lanes[k][j]));
+      for (auto n{0uz}; n < 4uz; ++n) {
+        __m128i tmp[16uz];
+        std::ranges::copy(rows, tmp);
+        for (auto k{0uz}; k < 8uz; ++k) {
+          rows[2uz * k] = _mm_unpacklo_epi8(tmp[k], tmp[k + 8uz]);
+          rows[2uz * k + 1uz] = _mm_unpackhi_epi8(tmp[k], tmp[k + 8uz]);
+        }
+      }
+      for (auto const& row : rows) {
+        auto const x{_mm_xor_si128(crcs, row)};
+        crcs = _mm_xor_si128(
+          _mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+          _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(x, 4), mask)));
+      }
+    }
+    std::array<uint8_t, 16uz> tmp;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data(tmp)), crcs);
+    for (auto k{0uz}; k < 16uz; ++k)
+      out[i + k] = crc8_update(tmp[k], lanes[k].subspan(len));
+  }
+  crc8_batch_scalar(in.subspan(i), out.subspan(i));
+}
+#endif
+
+/// Calculate CRC8 of many buffers at once
+///
+/// Uses crc8_batch_ssse3 if the CPU supports it, crc8_batch_scalar otherwise
+/// and during constant evaluation.
+///
+/// \param  in  Buffers
+/// \param  out CRC8 of each buffer, must be at least as large as in
+constexpr void crc8_batch(std::span<std::span<uint8_t const> const> in,
+                          std::span<uint8_t> out) {
+#if defined(ULF_SUSIV2_CRC8_SSSE3)
+  if !consteval {
+    if (__builtin_cpu_supports("ssse3")) return crc8_batch_ssse3(in, out);
+  }
+#endif
+  crc8_batch_scalar(in, out);
+}
+
+} // namespace ulf::susiv2
@@ -0,0 +1,283 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Host-side CV cache
+///
+/// Host only, this header allocates and is therefore not included by
+/// ulf/susiv2.hpp.
+///
+/// \file   ulf/susiv2/cv_cache.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <zusi/command.hpp>
+#include "crc8.hpp"
+#include "header.hpp"
+#include "multi.hpp"
+#include "packet_view.hpp"
+#include "response2feedback.hpp"
+#include "utility.hpp"
+
+namespace ulf::susiv2 {
+
+/// Maximum number of CVs a single CvRead can answer (response without ack and
+/// CRC8)
+inline constexpr size_t max_cvread_count{ULF_SUSIV2_MAX_RESPONSE_SIZE - 2uz};
+
+/// Consecutive CVs read by a single CvRead
+struct CvRange {
+  uint32_t addr{};  ///< Address of the first CV
+  uint8_t count{};  ///< Number of CVs - 1
+
+  constexpr bool operator==(CvRange const&) const = default;
+};
+
+/// Create CvRead packet
+///
+/// \param  range Consecutive CVs to read
+/// \return CvRead packet
+constexpr std::array<uint8_t, cvread_size> cvread_packet(CvRange range) {
+  std::array<uint8_t, cvread_size> packet{
+    std::to_underlying(zusi::Command::CvRead), range.count};
+  uint32_2data(range.addr, &packet[zusi::addr_pos]);
+  packet.back() = crc8_update(0u, std::span{packet}.first(cvread_size - 1uz));
+  return packet;
+}
+
+/// Plan CvReads covering a set of CVs
+///
+/// Each CvRead starts at the lowest CV not covered yet and spans as many CVs
+/// as max_count allows. CVs in between which weren't asked for are read along,
+/// that costs one byte of response but never an additional CvRead.
+///
+/// \param  addrs     CV addresses, unordered and possibly duplicate
+/// \param  max_count Maximum number of CVs per CvRead (1-256)
+/// \return CvReads in ascending order
+inline std::vector<CvRange> plan_cvreads(std::span<uint32_t const> addrs,
+                                         size_t max_count = max_cvread_count) {
+  std::vector<uint32_t> sorted(cbegin(addrs), cend(addrs));
+  std::ranges::sort(sorted);
+  max_count = std::clamp(max_count, 1uz, 256uz);
+  std::vector<CvRange> ranges;
+  for (auto first{cbegin(sorted)}; first != cend(sorted);) {
+    auto const addr{*first};
+    auto const last{std::find_if(first, cend(sorted), [&](uint32_t a) {
+      return a - addr >= max_count;
+    })};
+    ranges.push_back(
+      {.addr = addr, .count = static_cast<uint8_t>(*(last - 1) - addr)});
+    first = last;
+  }
+  return ranges;
+}
+
+/// Cache statistics
+struct CvCacheStats {
+  size_t hits{};          ///< get found CV
+  size_t misses{};        ///< get didn't find CV
+  size_t invalidations{}; ///< CVs dropped
+  size_t frames{};        ///< Frames sent by prefetch
+};
+
+/// Session-level CV cache
+///
+/// The cache is fed with every packet sent to the decoder and the feedback it
+/// returned:
+/// - CvRead stores the CVs read
+/// - CvWrite stores the CVs written (write-through), a failed CvWrite drops
+///   them since their state is unknown
+/// - ZppErase, ZppWrite and Exit drop all CVs, a flash update or leaving ZUSI
+///   may change any of them
+class CvCache {
+public:
+  /// Feedback of a packet, either its data or the error returned by
+  /// response2feedback
+  using feedback_type = std::expected<std::span<uint8_t const>, std::errc>;
+
+  /// Get CV, counts as hit or miss
+  ///
+  /// \param  addr          CV address
+  /// \retval uint8_t       Cached value
+  /// \retval std::nullopt  CV isn't cached
+  std::optional<uint8_t> get(uint32_t addr) {
+    if (auto const it{_cvs.find(addr)}; it != cend(_cvs)) {
+      ++_stats.hits;
+      return it->second;
+    }
+    ++_stats.misses;
+    return std::nullopt;
+  }
+
+  /// Check whether CV is cached without touching the statistics
+  ///
+  /// \param  addr  CV address
+  /// \return true if cached
+  bool contains(uint32_t addr) const { return _cvs.contains(addr); }
+
+  /// Get CV without touching the statistics
+  ///
+  /// \param  addr          CV address
+  /// \retval uint8_t       Cached value
+  /// \retval std::nullopt  CV isn't cached
+  std::optional<uint8_t> peek(uint32_t addr) const {
+    if (auto const it{_cvs.find(addr)}; it != cend(_cvs)) return it->second;
+    return std::nullopt;
+  }
+
+  /// Store consecutive CVs
+  ///
+  /// \param  addr    Address of the first CV
+  /// \param  values  Values
+  void put(uint32_t addr, std::span<uint8_t const> values) {
+    for (auto const value : values) _cvs.insert_or_assign(addr++, value);
+  }
+
+  /// Drop consecutive CVs
+  ///
+  /// \param  addr  Address of the first CV
+  /// \param  count Number of CVs
+  void invalidate(uint32_t addr, size_t count = 1uz) {
+    for (; count; --count) _stats.invalidations += _cvs.erase(addr++);
+  }
+
+  /// Drop all CVs
+  void invalidate() {
+    _stats.invalidations += size(_cvs);
+    _cvs.clear();
+  }
+
+  /// Observe packet sent to the decoder
+  ///
+  /// \param  packet  Validated ZUSI packet
+  /// \param  fb      Its feedback
+  void observe(std::span<uint8_t const> packet, feedback_type const& fb) {
+    visit_packet(
+      [&]<typename View>(View view) {
+        if constexpr (std::same_as<View, CvReadView>) {
+          if (fb && size(*fb) == view.count() + 1uz) put(view.address(), *fb);
+        } else if constexpr (std::same_as<View, CvWriteView>) {
+          if (fb) put(view.address(), view.data());
+          else invalidate(view.address(), view.count() + 1uz);
+        } else if constexpr (std::same_as<View, ZppEraseView> ||
+                             std::same_as<View, ZppWriteView> ||
+                             std::same_as<View, ExitView>)
+          invalidate();
+      },
+      packet);
+  }
+
+  /// Read all CVs which aren't cached yet
+  ///
+  /// Missing CVs are planned with plan_cvreads. Without limits every CvRead
+  /// is sent as a frame of its own, otherwise CvReads are packed into
+  /// multi-packet frames.
+  ///
+  /// \tparam F         Callable taking a frame and returning its complete
+  ///                   response as something convertible to
+  ///                   std::span<uint8_t const>
+  /// \param  addrs     CV addresses
+  /// \param  f         Transfers a frame
+  /// \param  limits    Negotiated limits for multi-packet frames
+  /// \retval size_t    Number of frames sent
+  /// \retval std::errc A CvRead was answered with a nak
+  ///                   (std::errc::io_error), a response was corrupt
+  ///                   (std::errc::protocol_error) or incomplete
+  ///                   (std::errc::timed_out) or limits are too small
+  ///                   (std::errc::invalid_argument)
+  template<std::invocable<std::span<uint8_t const>> F>
+  std::expected<size_t, std::errc>
+  prefetch(std::span<uint32_t const> addrs,
+           F&& f,
+           std::optional<Limits> limits = std::nullopt) {
+    std::vector<uint32_t> missing;
+    std::ranges::copy_if(addrs, std::back_inserter(missing), [&](uint32_t a) {
+      return !contains(a);
+    });
+    auto const ranges{plan_cvreads(missing)};
+    size_t frames{};
+
+    // One frame per CvRead
+    if (!limits) {
+      std::array<uint8_t, header_size + cvread_size> frame{};
+      frame[flags_pos] = busy_flag;
+      for (auto const& range : ranges) {
+        uint32_2data(range.count + 1u, &frame[answer_length_pos]);
+        std::ranges::copy(cvread_packet(range),
+                          begin(std::span{frame}.subspan(header_size)));
+        if (auto const r{transfer(f, frame, {&range, 1uz})}; !r)
+          return std::unexpected{r.error()};
+        ++frames;
+      }
+      return frames;
+    }
+
+    // As many CvReads per frame as limits allow
+    MultiFrame multi{*limits};
+    auto first{cbegin(ranges)};
+    for (auto it{first}; it != cend(ranges); ++it) {
+      auto const packet{cvread_packet(*it)};
+      if (multi.push_back(packet, it->count + 1u, true)) continue;
+      if (multi.count()) {
+        if (auto const r{transfer(f, multi.frame(), {first, it})}; !r)
+          return std::unexpected{r.error()};
+        ++frames;
+        multi.clear();
+        first = it;
+      }
+      // CvRead doesn't even fit into an empty frame
+      if (!multi.push_back(packet, it->count + 1u, true))
+        return std::unexpected{std::errc::invalid_argument};
+    }
+    if (multi.count()) {
+      if (auto const r{transfer(f, multi.frame(), {first, cend(ranges)})}; !r)
+        return std::unexpected{r.error()};
+      ++frames;
+    }
+    return frames;
+  }
+
+  /// Number of cached CVs
+  size_t count() const { return size(_cvs); }
+
+  /// Statistics
+  CvCacheStats const& stats() const { return _stats; }
+
+private:
+  /// Send frame and store the CVs of its response
+  template<typename F>
+  std::expected<void, std::errc> transfer(F& f,
+                                          std::span<uint8_t const> frame,
+                                          std::span<CvRange const> ranges) {
+    ++_stats.frames;
+    auto const resp{std::invoke(f, frame)};
+    std::span<uint8_t const> rest{resp};
+    for (auto const& range : ranges) {
+      auto const fb{response2feedback(rest, range.count + 1u)};
+      if (!fb) return std::unexpected{fb.error()};
+      if (!*fb) return std::unexpected{std::errc::timed_out};
+      put(range.addr, **fb);
+      rest = rest.subspan(1uz + size(**fb) + 1uz);
+    }
+    return {};
+  }
+
+  std::unordered_map<uint32_t, uint8_t> _cvs;
+  CvCacheStats _stats{};
+};
+
+} // namespace ulf::susiv2
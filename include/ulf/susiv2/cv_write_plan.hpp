@@ -0,0 +1,177 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Coalesce CvWrites
+///
+/// Host only, this header allocates and is therefore not included by
+/// ulf/susiv2.hpp.
+///
+/// \file   ulf/susiv2/cv_write_plan.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <zusi/command.hpp>
+#include "crc8.hpp"
+#include "header.hpp"
+#include "multi.hpp"
+#include "utility.hpp"
+
+namespace ulf::susiv2 {
+
+inline constexpr size_t max_cvwrite_size{cvwrite_size(0xFFu)};
+
+/// Single CV to write
+struct CvValue {
+  uint32_t addr{};
+  uint8_t value{};
+
+  constexpr bool operator==(CvValue const&) const = default;
+};
+
+/// Consecutive CVs written by a single CvWrite
+struct CvWriteRun {
+  uint32_t addr{};               ///< Address of the first CV
+  std::vector<uint8_t> values{}; ///< Values (1-256)
+
+  constexpr bool operator==(CvWriteRun const&) const = default;
+};
+
+/// Costs the planner weighs against each other
+///
+/// All costs are in byte times on the wire. Bridging a gap costs the gap
+/// values, a new frame costs header, CvWrite overhead and a round trip.
+struct CvWriteCosts {
+  size_t round_trip{16uz}; ///< Turnaround, busy phase and ack
+  size_t per_cv{1uz};      ///< Each additional CV
+};
+
+/// CvWrite plan
+struct CvWritePlan {
+  std::vector<CvWriteRun> runs{}; ///< One CvWrite frame each
+  size_t naive_frames{};          ///< Frames needed for one CV per frame
+  size_t bridged{};               ///< CVs rewritten with their known value
+
+  /// Number of frames
+  size_t frames() const { return size(runs); }
+
+  /// Frames saved compared to one CV per frame
+  size_t saved() const { return naive_frames - frames(); }
+};
+
+/// Plan CvWrites
+///
+/// CVs are sorted and adjacent ones are merged into a single CvWrite as long
+/// as the frame stays within limits. A gap between two runs is bridged by
+/// rewriting the known values of the CVs in between, if all of them are known
+/// and sending them is cheaper than another frame. If the same CV appears
+/// more than once, the last value wins.
+///
+/// \tparam F             Callable taking a CV address and returning
+///                       std::optional<uint8_t> with its known value
+/// \param  cvs           CVs to write, unordered
+/// \param  known         Known values of CVs not written (e.g. CvCache::peek)
+/// \param  limits        Negotiated limits
+/// \param  costs         Costs
+/// \retval CvWritePlan   Plan
+/// \retval std::errc     Frame limit too small for a single CvWrite
+template<std::invocable<uint32_t> F>
+requires std::convertible_to<std::invoke_result_t<F, uint32_t>,
+                             std::optional<uint8_t>>
+std::expected<CvWritePlan, std::errc>
+plan_cvwrites(std::span<CvValue const> cvs,
+              F&& known,
+              Limits limits = {},
+              CvWriteCosts costs = {}) {
+  auto const overhead{header_size + cvwrite_size(0u) - 1uz};
+  auto const frame_size{
+    std::min(limits.frame_size, size_t{ULF_SUSIV2_MAX_FRAME_SIZE})};
+  if (frame_size <= overhead)
+    return std::unexpected{std::errc::invalid_argument};
+  auto const max_count{std::min(frame_size - overhead, 256uz)};
+
+  // Sort, last value of duplicates wins
+  std::vector<CvValue> sorted(cbegin(cvs), cend(cvs));
+  std::ranges::stable_sort(sorted, {}, &CvValue::addr);
+  auto const [first, last]{std::ranges::unique(
+    rbegin(sorted), rend(sorted), {}, &CvValue::addr)};
+  sorted.erase(begin(sorted), first.base());
+
+  CvWritePlan plan{.naive_frames = size(sorted)};
+  for (auto const& cv : sorted) {
+    if (empty(plan.runs)) {
+      plan.runs.push_back({.addr = cv.addr, .values = {cv.value}});
+      continue;
+    }
+    auto& run{plan.runs.back()};
+    auto const next{run.addr + size(run.values)};
+    auto const gap{cv.addr - next};
+
+    // Bridge gap if all values are known and it's cheaper than a new frame
+    if (size(run.values) + gap < max_count &&
+        gap * costs.per_cv < overhead + costs.round_trip) {
+      std::vector<uint8_t> values;
+      for (auto i{0uz}; i < gap; ++i)
+        if (auto const value{std::invoke(known, next + i)})
+          values.push_back(*value);
+        else break;
+      if (size(values) == gap) {
+        run.values.insert(end(run.values), cbegin(values), cend(values));
+        run.values.push_back(cv.value);
+        plan.bridged += gap;
+        continue;
+      }
+    }
+    plan.runs.push_back({.addr = cv.addr, .values = {cv.value}});
+  }
+  return plan;
+}
+
+/// Plan CvWrites without any known values, only adjacent CVs get merged
+///
+/// \param  cvs         CVs to write, unordered
+/// \param  limits      Negotiated limits
+/// \retval CvWritePlan Plan
+/// \retval std::errc   Frame limit too small for a single CvWrite
+inline std::expected<CvWritePlan, std::errc>
+plan_cvwrites(std::span<CvValue const> cvs, Limits limits = {}) {
+  return plan_cvwrites(
+    cvs, [](uint32_t) -> std::optional<uint8_t> { return std::nullopt; },
+    limits);
+}
+
+/// Convert CvWrite run to frame
+///
+/// \param  addr  Address of the first CV
+/// \param  data  Values (1-256)
+/// \param  out   Buffer for the frame
+/// \return View on frame
+constexpr std::span<uint8_t const>
+cvwrite2frame(uint32_t addr,
+              std::span<uint8_t const> data,
+              std::span<uint8_t, header_size + max_cvwrite_size> out) {
+  uint32_2data(0u, &out[answer_length_pos]);
+  out[flags_pos] = busy_flag;
+  auto const packet{std::span{out}.subspan(header_size)};
+  packet[zusi::cmd_pos] = std::to_underlying(zusi::Command::CvWrite);
+  packet[zusi::data_cnt_pos] = static_cast<uint8_t>(size(data) - 1uz);
+  uint32_2data(addr, &packet[zusi::addr_pos]);
+  std::ranges::copy(data, begin(packet.subspan(zusi::data_pos)));
+  auto const packet_size{cvwrite_size(packet[zusi::data_cnt_pos])};
+  packet[packet_size - 1uz] = crc8_update(0u, packet.first(packet_size - 1uz));
+  return std::span<uint8_t const>{out}.first(header_size + packet_size);
+}
+
+} // namespace ulf::susiv2
@@ -0,0 +1,266 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Incremental frame decoder
+///
+/// \file   ulf/susiv2/decoder.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <utility>
+#include <ztl/inplace_vector.hpp>
+#include "compression.hpp"
+#include "frame2packet.hpp"
+#include "header.hpp"
+#include "multi.hpp"
+
+namespace ulf::susiv2 {
+
+/// Inter-byte timeout derived from baud rate
+///
+/// \param  baud  Baud rate
+/// \param  chars Allowed gap in characters (10 bit each)
+/// \return Timeout [µs]
+constexpr uint32_t inter_byte_timeout(uint32_t baud, uint32_t chars = 3u) {
+  return static_cast<uint32_t>(
+    (uint64_t{chars} * 10u * 1'000'000u + baud - 1u) / baud);
+}
+
+/// Helper to get the size of a SUSIV2 frame from its first bytes
+///
+/// \param  frame         Start of SUSIV2 frame
+/// \retval size_t        Size of the complete frame
+/// \retval std::nullopt  Frame is too short to determine its size
+/// \retval std::errc     Unknown command or sequenced frame
+constexpr std::expected<std::optional<size_t>, std::errc>
+get_frame_size(std::span<uint8_t const> frame) {
+  if (size(frame) <= header_size) return std::nullopt;
+  if (frame[flags_pos] & sequence_flag)
+    return std::unexpected{std::errc::not_supported};
+  auto const packet{frame.subspan(header_size)};
+  if (frame[flags_pos] & multi_flag) {
+    if (frame[flags_pos] & compressed_flag)
+      return std::unexpected{std::errc::not_supported};
+    return get_multi_frame_size(frame);
+  }
+  if (frame[flags_pos] & compressed_flag) {
+    if (packet[zusi::cmd_pos] != std::to_underlying(zusi::Command::ZppWrite))
+      return std::unexpected{std::errc::protocol_error};
+    if (size(packet) <= compressed_len_pos) return std::nullopt;
+    return header_size + compressed_zppwrite_size(packet[compressed_len_pos]);
+  }
+  auto const packet_size{get_packet_size(packet)};
+  if (!packet_size) return std::unexpected{packet_size.error()};
+  if (!*packet_size) return std::nullopt;
+  return header_size + **packet_size;
+}
+
+/// Incremental frame decoder
+///
+/// Collects chunks of a byte stream until a complete frame is received. A
+/// partial frame is discarded if no byte arrives for longer than the
+/// configured inter-byte timeout. Frames which turn out to be corrupt are
+/// discarded as well. Either way decoding resumes with the next byte.
+///
+/// Compressed ZppWrite frames are decompressed into a separate packet buffer
+/// of max_zppwrite_size bytes. Packets of multi-packet frames are returned one
+/// after the other, see remaining(). The sequence number of sequenced frames
+/// is removed from the frame and kept until the next frame, see sequence().
+class Decoder {
+public:
+  using result_type =
+    std::expected<std::optional<std::span<uint8_t const>>, std::errc>;
+
+  /// Ctor
+  ///
+  /// \param  timeout Inter-byte timeout [µs] (0 disables the timeout)
+  constexpr explicit Decoder(uint32_t timeout = 0u) : _timeout{timeout} {}
+
+  /// Receive chunk
+  ///
+  /// \param[in,out]  chunk         Received bytes, contains the bytes not yet
+  ///                               consumed on return
+  /// \param          now           Monotonic timestamp of chunk [µs]
+  /// \retval         std::span     View on packet, valid until next call
+  /// \retval         std::nullopt  Frame incomplete
+  /// \retval         std::errc     Frame corrupt and discarded
+  constexpr result_type receive(std::span<uint8_t const>& chunk,
+                                uint32_t now) {
+    if (_done && _remaining) return next();
+    if (_done) clear();
+    if (empty(chunk)) return std::nullopt;
+    if (size(_buf) && _timeout && now - _last > _timeout) drop();
+    _last = now;
+
+    while (!empty(chunk)) {
+      // Strip sequence number
+      if (size(_buf) == header_size && (_buf[flags_pos] & sequence_flag)) {
+        _buf[flags_pos] &= static_cast<uint8_t>(~sequence_flag);
+        _sequence = chunk.front();
+        chunk = chunk.subspan(1uz);
+        continue;
+      }
+
+      auto const n{std::min({_frame_size ? _frame_size - size(_buf)
+                             : _next >= size(_buf) ? _next - size(_buf) + 1uz
+                                                   : 1uz,
+                             size(chunk),
+                             _buf.capacity() - size(_buf)})};
+      if (!n) return discard(std::errc::message_size);
+      std::ranges::copy(chunk.first(n), std::back_inserter(_buf));
+      chunk = chunk.subspan(n);
+
+      // Size still unknown?
+      if (!_frame_size) {
+        auto const frame_size{size_frame()};
+        if (!frame_size) return discard(frame_size.error());
+        if (*frame_size) {
+          _frame_size = **frame_size;
+          if (_frame_size > _buf.capacity())
+            return discard(std::errc::message_size);
+        }
+      }
+
+      // Complete?
+      if (_frame_size && size(_buf) == _frame_size) {
+        if (_buf[flags_pos] & multi_flag) {
+          auto const count{frame2packets(_buf, [](auto) {})};
+          if (!count || !*count) return discard(std::errc::protocol_error);
+          _done = true;
+          _next = multi_header_size;
+          _remaining = **count;
+          return next();
+        }
+        auto const packet{frame2packet(_buf, _packet)};
+        if (!packet || !*packet) return discard(std::errc::protocol_error);
+        _done = true;
+        return packet;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  /// Receive chunk
+  ///
+  /// \param  chunk         Received bytes, must not contain more than one frame
+  /// \param  now           Monotonic timestamp of chunk [µs]
+  /// \retval std::span     View on packet, valid until next call
+  /// \retval std::nullopt  Frame incomplete
+  /// \retval std::errc     Frame corrupt and discarded
+  constexpr result_type receive(std::span<uint8_t const>&& chunk,
+                                uint32_t now) {
+    return receive(chunk, now);
+  }
+
+  /// Number of bytes received so far
+  constexpr size_t pending() const {
+    return _done ? 0uz : size(_buf) + _sequence.has_value();
+  }
+
+  /// Number of packets of the current multi-packet frame not returned yet
+  ///
+  /// Once a multi-packet frame is complete, further calls to receive return
+  /// its remaining packets without consuming the chunk. The aggregated response
+  /// is due after the packet for which this returns 0 has been handled.
+  constexpr size_t remaining() const { return _remaining; }
+
+  /// Current frame is a multi-packet frame
+  constexpr bool multi() const {
+    return _done && (_buf[flags_pos] & multi_flag);
+  }
+
+  /// Sequence number of the current frame (if any)
+  ///
+  /// Responses to sequenced frames must echo it, see feedback2response.
+  constexpr std::optional<uint8_t> sequence() const { return _sequence; }
+
+  /// Total number of bytes discarded due to timeouts or corrupt frames
+  constexpr size_t dropped() const { return _dropped; }
+
+  /// Timeout [µs]
+  constexpr uint32_t timeout() const { return _timeout; }
+
+  /// Discard any partial frame
+  constexpr void reset() {
+    if (!_done) _dropped += size(_buf) + _sequence.has_value();
+    clear();
+  }
+
+private:
+  constexpr std::expected<std::optional<size_t>, std::errc> size_frame() {
+    if (size(_buf) <= header_size || !(_buf[flags_pos] & multi_flag))
+      return get_frame_size(_buf);
+    if (_buf[flags_pos] & compressed_flag)
+      return std::unexpected{std::errc::not_supported};
+
+    // Size packets of a multi-packet frame as they arrive
+    if (!_next) {
+      if (!_buf[multi_count_pos])
+        return std::unexpected{std::errc::protocol_error};
+      _next = multi_header_size;
+      _remaining = _buf[multi_count_pos];
+    }
+    for (; _remaining; --_remaining) {
+      auto const packet_size{get_packet_size(
+        std::span<uint8_t const>{_buf}.subspan(std::min(_next, size(_buf))))};
+      if (!packet_size) return std::unexpected{packet_size.error()};
+      if (!*packet_size) return std::nullopt;
+      _next += **packet_size;
+      // Bail out before the next packet would be read past the buffer
+      if (_next > _buf.capacity() ||
+          (_remaining > 1uz && _next >= _buf.capacity()))
+        return std::unexpected{std::errc::message_size};
+    }
+    return _next;
+  }
+
+  constexpr result_type next() {
+    auto const packet{std::span<uint8_t const>{_buf}.subspan(_next)};
+    auto const packet_size{**get_packet_size(packet)};
+    _next += packet_size;
+    --_remaining;
+    return packet.first(packet_size);
+  }
+
+  constexpr void clear() {
+    _buf.clear();
+    _frame_size = _next = _remaining = 0uz;
+    _sequence.reset();
+    _done = false;
+  }
+
+  constexpr void drop() {
+    _dropped += size(_buf) + _sequence.has_value();
+    clear();
+  }
+
+  constexpr result_type discard(std::errc ec) {
+    drop();
+    return std::unexpected{ec};
+  }
+
+  ztl::inplace_vector<uint8_t, ULF_SUSIV2_MAX_FRAME_SIZE> _buf{};
+  std::array<uint8_t, max_zppwrite_size> _packet{};
+  size_t _frame_size{};
+  size_t _next{};      ///< Offset of next packet of multi-packet frame
+  size_t _remaining{}; ///< Packets of multi-packet frame left
+  size_t _dropped{};
+  std::optional<uint8_t> _sequence{};
+  uint32_t _timeout{};
+  uint32_t _last{};
+  bool _done{};
+};
+
+} // namespace ulf::susiv2
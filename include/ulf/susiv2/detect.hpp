@@ -0,0 +1,106 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Detect SUSIV2 on a shared port
+///
+/// \file   ulf/susiv2/detect.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <zusi/command.hpp>
+#include "compression.hpp"
+#include "crc8.hpp"
+#include "header.hpp"
+#include "utility.hpp"
+
+namespace ulf::susiv2 {
+
+/// Confidence that a byte stream carries SUSIV2
+enum class Confidence : uint8_t {
+  None,   ///< Contradicts SUSIV2
+  Low,    ///< Nothing contradicts SUSIV2 yet
+  Medium, ///< Plausible header and command
+  High,   ///< Complete packet with matching CRC8
+};
+
+/// Detect SUSIV2 from the first bytes of a stream
+///
+/// Checks as far as the bytes allow, in this order:
+/// - the answer length fits into a response (its leading bytes are 0)
+/// - no unknown flags and no compressed multi-packet frame
+/// - the multi-packet count isn't 0
+/// - the command is valid (and ZppWrite if compressed)
+/// - ZppErase and Exit carry their security bytes 0x55 0xAA
+/// - the (first) packet fits into a frame
+/// - the CRC8 of the (first) packet matches
+/// Only about one in 2^24 random streams passes the first check, text fails
+/// it on the first byte. The bytes are only inspected, once SUSIV2 has been
+/// detected they can be passed on to a Decoder as they are.
+///
+/// \param  bytes First bytes of a stream
+/// \return Confidence
+constexpr Confidence detect(std::span<uint8_t const> bytes) {
+  // Answer length is big-endian, smallest possible value of the bytes so far
+  uint64_t answer_length{};
+  for (auto i{0uz}; i < flags_pos; ++i)
+    answer_length = answer_length << 8u | (i < size(bytes) ? bytes[i] : 0u);
+  if (answer_length > ULF_SUSIV2_MAX_MULTI_RESPONSE_SIZE)
+    return Confidence::None;
+  if (size(bytes) <= flags_pos) return Confidence::Low;
+
+  // Flags
+  auto const flags{bytes[flags_pos]};
+  if (flags & ~(busy_flag | compressed_flag | multi_flag | sequence_flag) ||
+      ((flags & compressed_flag) && (flags & multi_flag)) ||
+      (!(flags & multi_flag) &&
+       1uz + answer_length + 1uz > ULF_SUSIV2_MAX_RESPONSE_SIZE))
+    return Confidence::None;
+  auto pos{flags & sequence_flag ? sequence_header_size : header_size};
+  auto frame_size{header_size};
+  if (flags & multi_flag) {
+    if (size(bytes) <= pos) return Confidence::Low;
+    if (!bytes[pos]) return Confidence::None;
+    ++pos;
+    ++frame_size;
+  }
+  if (size(bytes) <= pos) return Confidence::Low;
+
+  // Command
+  auto const packet{bytes.subspan(pos)};
+  auto const cmd{packet[zusi::cmd_pos]};
+  if (!zusi::is_valid_command(cmd) ||
+      ((flags & compressed_flag) &&
+       cmd != std::to_underlying(zusi::Command::ZppWrite)))
+    return Confidence::None;
+  if (cmd == std::to_underlying(zusi::Command::ZppErase) ||
+      cmd == std::to_underlying(zusi::Command::Exit))
+    for (auto i{1uz}; i < std::min(size(packet), 3uz); ++i)
+      if (packet[i] != (i == 1uz ? 0x55u : 0xAAu)) return Confidence::None;
+
+  // Size
+  std::optional<size_t> packet_size;
+  if (!(flags & compressed_flag)) {
+    auto const expected{get_packet_size(packet)};
+    if (!expected) return Confidence::None;
+    packet_size = *expected;
+  } else if (size(packet) > compressed_len_pos)
+    packet_size = compressed_zppwrite_size(packet[compressed_len_pos]);
+  if (!packet_size) return Confidence::Medium;
+  if (frame_size + *packet_size > ULF_SUSIV2_MAX_FRAME_SIZE)
+    return Confidence::None;
+  if (size(packet) < *packet_size) return Confidence::Medium;
+
+  // CRC8 over packet including its checksum is 0
+  return crc8_update(0u, packet.first(*packet_size)) ? Confidence::None
+                                                     : Confidence::High;
+}
+
+} // namespace ulf::susiv2
@@ -0,0 +1,145 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Plan ZppErase and aligned ZppWrites
+///
+/// Host only, this header allocates and is therefore not included by
+/// ulf/susiv2.hpp.
+///
+/// \file   ulf/susiv2/flash_plan.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <vector>
+
+namespace ulf::susiv2 {
+
+/// Value of erased flash
+inline constexpr uint8_t flash_erased{0xFFu};
+
+/// Flash geometry of the decoder
+struct FlashGeometry {
+  uint32_t size{};             ///< Size of the whole flash
+  uint32_t sector_size{4096u}; ///< Smallest erasable unit
+  uint32_t page_size{256u};    ///< Largest unit programmable at once
+};
+
+/// Flash timing of the decoder
+///
+/// Defaults are typical for SPI NOR flash.
+struct FlashTiming {
+  uint32_t sector_erase_us{45'000u}; ///< Busy time to erase one sector
+  uint32_t page_program_us{700u};    ///< Busy time to program one page
+};
+
+/// Single ZppWrite
+struct FlashChunk {
+  uint32_t addr{};   ///< Flash address
+  uint32_t offset{}; ///< Offset into image
+  uint16_t size{};   ///< Number of bytes (1-256)
+
+  constexpr bool operator==(FlashChunk const&) const = default;
+};
+
+/// Flash plan
+struct FlashPlan {
+  bool erase{};                     ///< ZppErase first
+  std::vector<FlashChunk> chunks{}; ///< ZppWrites in ascending order
+  uint64_t busy_us{};               ///< Estimated total busy time
+};
+
+/// Plan ZppErase and ZppWrites
+///
+/// ZppErase always erases the whole flash, so the plan either erases once
+/// and writes all pages which aren't blank, or doesn't erase at all and only
+/// writes pages which changed. The latter is only possible if the current
+/// content is known and programming merely clears bits. ZppWrites start on
+/// page boundaries, never cross a sector and cover as many consecutive pages
+/// as 256 bytes allow. Pages larger than 256 bytes are written in 256 byte
+/// steps.
+///
+/// \param  image       Image
+/// \param  addr        Flash address of the first byte of the image
+/// \param  geometry    Flash geometry
+/// \param  current     Current flash content at the same addresses, if known
+/// \param  timing      Flash timing
+/// \retval FlashPlan   Plan
+/// \retval std::errc   Geometry is invalid, current content doesn't match the
+///                     size of the image or image exceeds flash
+inline std::expected<FlashPlan, std::errc>
+plan_flash(std::span<uint8_t const> image,
+           uint32_t addr,
+           FlashGeometry const& geometry,
+           std::optional<std::span<uint8_t const>> current = std::nullopt,
+           FlashTiming const& timing = {}) {
+  if (!geometry.page_size || !geometry.sector_size ||
+      geometry.sector_size % geometry.page_size ||
+      (current && size(*current) != size(image)) ||
+      uint64_t{addr} + size(image) > geometry.size)
+    return std::unexpected{std::errc::invalid_argument};
+
+  // Split image into slices at page boundaries, larger pages additionally
+  // every 256 bytes
+  struct Slice {
+    uint32_t offset;
+    uint32_t size;
+  };
+  std::vector<Slice> slices;
+  for (uint32_t offset{}; offset < size(image);) {
+    auto const pos{(addr + offset) % geometry.page_size};
+    auto const n{std::min({geometry.page_size - pos,
+                           256u - pos % 256u,
+                           static_cast<uint32_t>(size(image) - offset)})};
+    slices.push_back({offset, n});
+    offset += n;
+  }
+
+  // Programming can only clear bits
+  auto const clears_only{[](uint8_t n, uint8_t o) { return !(n & ~o); }};
+  auto const erase{!current ||
+                   !std::ranges::equal(image, *current, clears_only)};
+  auto const dirty{[&](Slice s) {
+    auto const bytes{image.subspan(s.offset, s.size)};
+    return erase ? std::ranges::any_of(
+                     bytes, [](uint8_t b) { return b != flash_erased; })
+                 : !std::ranges::equal(bytes,
+                                       current->subspan(s.offset, s.size));
+  }};
+
+  // Merge consecutive dirty pages within a sector
+  FlashPlan plan{.erase = erase};
+  if (erase)
+    plan.busy_us = uint64_t{(geometry.size + geometry.sector_size - 1u) /
+                            geometry.sector_size} *
+                   timing.sector_erase_us;
+  for (auto const s : slices) {
+    if (!dirty(s)) continue;
+    plan.busy_us += timing.page_program_us;
+    auto const chunk_addr{addr + s.offset};
+    if (!empty(plan.chunks)) {
+      auto& last{plan.chunks.back()};
+      if (last.addr + last.size == chunk_addr && last.size + s.size <= 256u &&
+          last.addr / geometry.sector_size ==
+            chunk_addr / geometry.sector_size &&
+          !(chunk_addr % geometry.page_size)) {
+        last.size = static_cast<uint16_t>(last.size + s.size);
+        continue;
+      }
+    }
+    plan.chunks.push_back({.addr = chunk_addr,
+                           .offset = s.offset,
+                           .size = static_cast<uint16_t>(s.size)});
+  }
+  return plan;
+}
+
+} // namespace ulf::susiv2
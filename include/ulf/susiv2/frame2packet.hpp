@@ -13,6 +13,8 @@
 #include <expected>
 #include <optional>
 #include <system_error>
+#include "header.hpp"
+#include "parse_result.hpp"
 #include "validate.hpp"
 
 namespace ulf::susiv2 {
@@ -23,69 +25,66 @@ namespace ulf::susiv2 {
 ///                       frame on return
 constexpr std::span<uint8_t const>
 frame2packet_no_validate(std::span<uint8_t const>& frame) {
-  return frame.subspan(5uz);
+  return frame.subspan(header_size);
+}
+
+namespace flat {
+
+/// Locate ZUSI packet in frame without checking its checksum
+///
+/// Bytes after the packet are ignored.
+///
+/// \param  frame                   SUSIV2 frame
+/// \retval std::span               View on packet
+/// \retval Status::Incomplete      Frame incomplete
+/// \retval Status::UnknownCommand  Unknown command
+/// \retval Status::BadHeader       Frame is compressed (see compression.hpp),
+///                                 multi-packet (see multi.hpp) or sequenced
+///                                 (see pipeline.hpp)
+constexpr ParseResult<std::span<uint8_t const>>
+locate_packet(std::span<uint8_t const> frame) {
+  if (size(frame) < header_size + 2uz) return Status::Incomplete;
+  if (frame[flags_pos] & (compressed_flag | multi_flag | sequence_flag))
+    return Status::BadHeader;
+  auto const packet{frame.subspan(header_size)};
+  auto const packet_size{get_packet_size(packet)};
+  if (!packet_size) return packet_size.status();
+  if (size(packet) < *packet_size) return Status::Incomplete;
+  return packet.first(*packet_size);
 }
 
 /// Convert frame to ZUSI packet
 ///
-/// \param[in,out]  frame         SUSIV2 frame to be converted, will contain the
-///                               ZUSI frame on successful verification
-/// \retval         std::span     View on packet
-/// \retval         std::nullopt  Frame incomplete
-/// \retval         std::errc     Frame corrupt
-constexpr std::expected<std::optional<std::span<uint8_t const>>, std::errc>
+/// \param  frame                   SUSIV2 frame to be converted
+/// \retval std::span               View on packet
+/// \retval Status::Incomplete      Frame incomplete
+/// \retval Status::Corrupt         Checksum mismatch
+/// \retval Status::UnknownCommand  Unknown command
+/// \retval Status::BadHeader       Frame is compressed (see compression.hpp),
+///                                 multi-packet (see multi.hpp) or sequenced
+///                                 (see pipeline.hpp)
+constexpr ParseResult<std::span<uint8_t const>>
 frame2packet(std::span<uint8_t const> frame) {
-  if (size(frame) < 7uz) return std::nullopt;
-
-  auto result{frame.subspan(5uz)};
-  auto const cmd{get_command(result)};
-  if (!cmd) return std::unexpected{cmd.error()};
-  if (!*cmd) return std::nullopt;
-
-  switch (**cmd) {
-    case zusi::Command::CvRead:
-      if (size(result) >= cvread_size)
-        result = result.subspan(0uz, cvread_size);
-      else return std::nullopt;
-      break;
-    case zusi::Command::CvWrite:
-      if (size(result) >= cvwrite_size(result[zusi::data_cnt_pos]))
-        result = result.subspan(0uz, cvwrite_size(result[zusi::data_cnt_pos]));
-      else return std::nullopt;
-      break;
-    case zusi::Command::ZppWrite:
-      if (size(result) >= zppwrite_size(result[zusi::data_cnt_pos]))
-        result = result.subspan(0uz, zppwrite_size(result[zusi::data_cnt_pos]));
-      else return std::nullopt;
-      break;
-    case zusi::Command::ZppErase:
-      if (size(result) >= zpperase_size)
-        result = result.subspan(0uz, zpperase_size);
-      else return std::nullopt;
-      break;
-    case zusi::Command::Features:
-      if (size(result) >= features_size)
-        result = result.subspan(0uz, features_size);
-      else return std::nullopt;
-      break;
-    case zusi::Command::Exit:
-      if (size(result) >= exit_size) result = result.subspan(0uz, exit_size);
-      else return std::nullopt;
-      break;
-    case zusi::Command::ZppLcDcQuery:
-      if (size(result) >= zpplcdcquery_size)
-        result = result.subspan(0uz, zpplcdcquery_size);
-      else return std::nullopt;
-      break;
-    default: break;
-  }
+  auto const packet{locate_packet(frame)};
+  if (!packet) return packet;
+  auto const status{validate(*packet)};
+  if (status != Status::Ok) return status;
+  return packet;
+}
 
-  // Could be command?
-  auto const valid{validate(result)};
+} // namespace flat
 
-  if (!valid) return std::unexpected{valid.error()};
-  if (!*valid) return std::nullopt;
-  return result;
+/// Convert frame to ZUSI packet
+///
+/// \param  frame         SUSIV2 frame to be converted
+/// \retval std::span     View on packet
+/// \retval std::nullopt  Frame incomplete
+/// \retval std::errc     Frame corrupt, compressed (see compression.hpp),
+///                       multi-packet (see multi.hpp) or sequenced (see
+///                       pipeline.hpp)
+constexpr std::expected<std::optional<std::span<uint8_t const>>, std::errc>
+frame2packet(std::span<uint8_t const> frame) {
+  return to_expected<std::span<uint8_t const>>(flat::frame2packet(frame));
 }
 
 } // namespace ulf::susiv2
@@ -0,0 +1,259 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Precompiled ZppWrite frame stream
+///
+/// Host only, this header uses threads and is therefore not included by
+/// ulf/susiv2.hpp.
+///
+/// \file   ulf/susiv2/frame_cache.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <iterator>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "compression.hpp"
+#include "header.hpp"
+#include "utility.hpp"
+
+namespace ulf::susiv2 {
+
+/// Frame cache layout
+///
+/// A frame cache starts with a 24 byte header followed by an index of
+/// count + 1 offsets (4 bytes each) and the frame stream itself.
+/// | magic (4) | version | chunk size - 1 | options | reserved |
+/// | image hash (8) | address (4) | image size (4) |
+/// Offsets are relative to the start of the frame stream, the last one is its
+/// size. All multi-byte fields are big-endian, the same as the SUSIV2 header.
+inline constexpr std::array<uint8_t, 4uz> frame_cache_magic{
+  'S', 'V', '2', 'F'};
+inline constexpr uint8_t frame_cache_version{1u};
+inline constexpr size_t frame_cache_header_size{24uz};
+
+/// Frame cache options
+inline constexpr uint8_t frame_cache_compressed{1u << 0u};
+
+/// 64 bit FNV-1a hash
+///
+/// \param  bytes Bytes to hash
+/// \return Hash
+constexpr uint64_t fnv1a(std::span<uint8_t const> bytes) {
+  uint64_t hash{0xCBF2'9CE4'8422'2325u};
+  for (auto const b : bytes) hash = (hash ^ b) * 0x0000'0100'0000'01B3u;
+  return hash;
+}
+
+/// Everything a frame stream depends on
+struct FrameCacheKey {
+  uint64_t hash{};           ///< FNV-1a hash of the image
+  uint32_t addr{};           ///< Address of the first byte of the image
+  uint32_t size{};           ///< Size of the image
+  uint16_t chunk_size{256u}; ///< Data bytes per ZppWrite frame (1-256)
+  bool compress{};           ///< Allow compressed ZppWrite frames
+
+  constexpr bool operator==(FrameCacheKey const&) const = default;
+};
+
+/// Create frame cache key
+///
+/// \param  image       Image
+/// \param  addr        Address of the first byte of the image
+/// \param  chunk_size  Data bytes per ZppWrite frame (1-256)
+/// \param  compress    Allow compressed ZppWrite frames
+/// \return Key
+constexpr FrameCacheKey make_frame_cache_key(std::span<uint8_t const> image,
+                                             uint32_t addr,
+                                             uint16_t chunk_size = 256u,
+                                             bool compress = false) {
+  return {.hash = fnv1a(image),
+          .addr = addr,
+          .size = static_cast<uint32_t>(size(image)),
+          .chunk_size = std::clamp<uint16_t>(chunk_size, 1u, 256u),
+          .compress = compress};
+}
+
+/// Number of frames
+///
+/// \param  key Key
+/// \return Number of frames
+constexpr size_t frame_cache_count(FrameCacheKey const& key) {
+  return (key.size + key.chunk_size - 1uz) / key.chunk_size;
+}
+
+/// Size of a buffer able to hold the frame cache of a key
+///
+/// \param  key Key
+/// \return Size of buffer
+constexpr size_t frame_cache_max_size(FrameCacheKey const& key) {
+  auto const count{frame_cache_count(key)};
+  return frame_cache_header_size + (count + 1uz) * 4uz +
+         count * (header_size + zppwrite_size(
+                                  static_cast<uint8_t>(key.chunk_size - 1u)));
+}
+
+/// View on a frame cache
+class FrameCacheView {
+public:
+  constexpr FrameCacheView() = default;
+  constexpr FrameCacheView(FrameCacheKey const& key,
+                           std::span<uint8_t const> index,
+                           std::span<uint8_t const> stream)
+    : _key{key}, _index{index}, _stream{stream} {}
+
+  /// Key the frame stream was built for
+  constexpr FrameCacheKey const& key() const { return _key; }
+
+  /// Number of frames
+  constexpr size_t count() const { return size(_index) / 4uz - 1uz; }
+
+  /// Get frame
+  ///
+  /// \param  i Index of frame
+  /// \return View on frame
+  constexpr std::span<uint8_t const> operator[](size_t i) const {
+    auto const first{offset(i)};
+    return _stream.subspan(first, offset(i + 1uz) - first);
+  }
+
+  /// Get all frames, ready to be sent back to back
+  constexpr std::span<uint8_t const> stream() const { return _stream; }
+
+private:
+  constexpr size_t offset(size_t i) const {
+    return zusi::data2uint32(&_index[i * 4uz]);
+  }
+
+  FrameCacheKey _key{};
+  std::span<uint8_t const> _index{};
+  std::span<uint8_t const> _stream{};
+};
+
+/// Build frame cache
+///
+/// Frames are encoded in parallel into slots of the largest possible frame
+/// size, which are then moved together.
+///
+/// \param  image   Image
+/// \param  key     Key created from image
+/// \param  out     Buffer of at least frame_cache_max_size(key) bytes
+/// \param  threads Number of threads (0 uses all cores)
+/// \retval size_t    Size of the frame cache
+/// \retval std::errc Image or chunk size don't match key or out is too small
+inline std::expected<size_t, std::errc>
+build_frame_cache(std::span<uint8_t const> image,
+                  FrameCacheKey const& key,
+                  std::span<uint8_t> out,
+                  size_t threads = 0uz) {
+  if (!key.chunk_size || key.chunk_size > 256u || size(image) != key.size ||
+      size(out) < frame_cache_max_size(key))
+    return std::unexpected{std::errc::invalid_argument};
+
+  auto const count{frame_cache_count(key)};
+  auto const slot_size{
+    header_size + zppwrite_size(static_cast<uint8_t>(key.chunk_size - 1u))};
+  auto const index{out.subspan(frame_cache_header_size, (count + 1uz) * 4uz)};
+  auto const stream{out.subspan(frame_cache_header_size + size(index))};
+  std::vector<uint32_t> sizes(count);
+
+  // Encode
+  auto const encode{[&](size_t first, size_t last) {
+    std::array<uint8_t, header_size + max_zppwrite_size> buf;
+    for (auto i{first}; i < last; ++i) {
+      auto const offset{i * key.chunk_size};
+      auto const frame{zppwrite2frame(
+        static_cast<uint32_t>(key.addr + offset),
+        image.subspan(offset, std::min<size_t>(key.chunk_size,
+                                               size(image) - offset)),
+        buf,
+        0u,
+        key.compress)};
+      std::ranges::copy(frame, begin(stream.subspan(i * slot_size)));
+      sizes[i] = static_cast<uint32_t>(size(frame));
+    }
+  }};
+  if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::clamp(threads, 1uz, std::max(1uz, count));
+  {
+    std::vector<std::jthread> workers;
+    for (auto t{1uz}; t < threads; ++t)
+      workers.emplace_back(
+        encode, count * t / threads, count * (t + 1uz) / threads);
+    encode(0uz, count / threads);
+  }
+
+  // Move slots together
+  size_t o{};
+  for (auto i{0uz}; i < count; ++i) {
+    uint32_2data(static_cast<uint32_t>(o), &index[i * 4uz]);
+    std::ranges::copy(stream.subspan(i * slot_size, sizes[i]),
+                      begin(stream.subspan(o)));
+    o += sizes[i];
+  }
+  uint32_2data(static_cast<uint32_t>(o), &index[count * 4uz]);
+
+  // Header
+  std::ranges::copy(frame_cache_magic, begin(out));
+  out[4uz] = frame_cache_version;
+  out[5uz] = static_cast<uint8_t>(key.chunk_size - 1u);
+  out[6uz] = key.compress ? frame_cache_compressed : 0u;
+  out[7uz] = 0u;
+  uint32_2data(static_cast<uint32_t>(key.hash >> 32u), &out[8uz]);
+  uint32_2data(static_cast<uint32_t>(key.hash), &out[12uz]);
+  uint32_2data(key.addr, &out[16uz]);
+  uint32_2data(key.size, &out[20uz]);
+  return frame_cache_header_size + size(index) + o;
+}
+
+/// Open frame cache
+///
+/// \param  cache           Complete frame cache (e.g. memory-mapped file)
+/// \param  key             Key the frame cache must have been built for
+/// \retval FrameCacheView  View on frames
+/// \retval std::errc       Wrong magic, unsupported version, stale (key
+///                         doesn't match) or truncated
+constexpr std::expected<FrameCacheView, std::errc>
+read_frame_cache(std::span<uint8_t const> cache, FrameCacheKey const& key) {
+  if (size(cache) < frame_cache_header_size ||
+      !std::ranges::equal(cache.first(size(frame_cache_magic)),
+                          frame_cache_magic) ||
+      cache[4uz] != frame_cache_version)
+    return std::unexpected{std::errc::protocol_error};
+
+  auto const stored{FrameCacheKey{
+    .hash = uint64_t{zusi::data2uint32(&cache[8uz])} << 32u |
+            zusi::data2uint32(&cache[12uz]),
+    .addr = zusi::data2uint32(&cache[16uz]),
+    .size = zusi::data2uint32(&cache[20uz]),
+    .chunk_size = static_cast<uint16_t>(cache[5uz] + 1u),
+    .compress = static_cast<bool>(cache[6uz] & frame_cache_compressed)}};
+  if (stored != key) return std::unexpected{std::errc::invalid_argument};
+
+  // Offsets must be ascending and end with the stream
+  auto const count{frame_cache_count(key)};
+  auto const index_size{(count + 1uz) * 4uz};
+  if (size(cache) < frame_cache_header_size + index_size)
+    return std::unexpected{std::errc::protocol_error};
+  auto const index{cache.subspan(frame_cache_header_size, index_size)};
+  auto const stream{cache.subspan(frame_cache_header_size + index_size)};
+  uint32_t prev{};
+  for (auto i{0uz}; i <= count; ++i) {
+    auto const offset{zusi::data2uint32(&index[i * 4uz])};
+    if (offset < prev) return std::unexpected{std::errc::protocol_error};
+    prev = offset;
+  }
+  if (size(stream) != prev) return std::unexpected{std::errc::protocol_error};
+  return FrameCacheView{key, index, stream};
+}
+
+} // namespace ulf::susiv2
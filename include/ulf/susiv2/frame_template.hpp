@@ -0,0 +1,125 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Frame template for repeated frame generation
+///
+/// \file   ulf/susiv2/frame_template.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <zusi/command.hpp>
+#include "crc8.hpp"
+#include "header.hpp"
+#include "utility.hpp"
+
+namespace ulf::susiv2 {
+
+/// Frame template for CvRead, CvWrite and ZppWrite frames
+///
+/// Header, command and count are written once on construction. Consecutive
+/// frames then only update address and/or data. Since the CRC8 is linear, the
+/// checksum is patched instead of recalculated:
+/// - changing the address only costs 4 table lookups
+/// - changing the data costs one table lookup per data byte
+class FrameTemplate {
+public:
+  /// Ctor
+  ///
+  /// \param  cmd           Command (CvRead, CvWrite or ZppWrite)
+  /// \param  cnt           Count (number of CVs or data bytes - 1)
+  /// \param  answer_length Length of the expected answer
+  /// \param  busy          ZUSI command contains a busy phase
+  constexpr FrameTemplate(zusi::Command cmd,
+                          uint8_t cnt,
+                          uint32_t answer_length,
+                          bool busy)
+    : _data_size{cmd == zusi::Command::CvRead ? 0uz : cnt + 1uz} {
+    uint32_2data(answer_length, &_buf[answer_length_pos]);
+    _buf[flags_pos] = busy ? busy_flag : 0u;
+    _buf[header_size + zusi::cmd_pos] = std::to_underlying(cmd);
+    _buf[header_size + zusi::data_cnt_pos] = cnt;
+    _prefix = crc8_update(
+      0u, std::span{&_buf[header_size], zusi::addr_pos - zusi::cmd_pos});
+
+    // Advancing a CRC8 state over the data is linear as well, store the image
+    // of each bit
+    std::array<uint8_t, 256uz> zeros{};
+    for (auto i{0uz}; i < size(_advance); ++i)
+      _advance[i] = crc8_update(static_cast<uint8_t>(1u << i),
+                                std::span{cbegin(zeros), _data_size});
+
+    address(0u);
+    _data_crc = crc8_update(0u, data_span());
+    _buf[crc_pos()] = _addr_crc ^ _data_crc;
+  }
+
+  /// Set address
+  ///
+  /// \param  addr  Address
+  /// \return *this
+  constexpr FrameTemplate& address(uint32_t addr) {
+    auto const first{&_buf[header_size + zusi::addr_pos]};
+    uint32_2data(addr, first);
+    _addr_crc = advance(crc8_update(_prefix, std::span{first, 4uz}));
+    _buf[crc_pos()] = _addr_crc ^ _data_crc;
+    return *this;
+  }
+
+  /// Set data
+  ///
+  /// \param  bytes Data, must contain cnt + 1 bytes
+  /// \return *this
+  constexpr FrameTemplate& data(std::span<uint8_t const> bytes) {
+    std::ranges::copy(bytes.first(_data_size), begin(data_span()));
+    _data_crc = crc8_update(0u, data_span());
+    _buf[crc_pos()] = _addr_crc ^ _data_crc;
+    return *this;
+  }
+
+  /// Get frame
+  ///
+  /// \return View on complete SUSIV2 frame
+  constexpr std::span<uint8_t const> frame() const {
+    return {cbegin(_buf), crc_pos() + 1uz};
+  }
+
+  /// Get packet
+  ///
+  /// \return View on ZUSI packet
+  constexpr std::span<uint8_t const> packet() const {
+    return frame().subspan(header_size);
+  }
+
+private:
+  constexpr size_t crc_pos() const {
+    return header_size + zusi::data_pos + _data_size;
+  }
+
+  constexpr std::span<uint8_t> data_span() {
+    return {&_buf[header_size + zusi::data_pos], _data_size};
+  }
+
+  constexpr uint8_t advance(uint8_t crc) const {
+    uint8_t retval{};
+    for (auto i{0uz}; i < size(_advance); ++i)
+      if (crc & (1u << i)) retval ^= _advance[i];
+    return retval;
+  }
+
+  std::array<uint8_t, ULF_SUSIV2_MAX_FRAME_SIZE> _buf{};
+  std::array<uint8_t, 8uz> _advance{};
+  size_t _data_size{};
+  uint8_t _prefix{};
+  uint8_t _addr_crc{};
+  uint8_t _data_crc{};
+};
+
+} // namespace ulf::susiv2
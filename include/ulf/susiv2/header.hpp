@@ -0,0 +1,73 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// SUSIV2 header
+///
+/// \file   ulf/susiv2/header.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <zusi/utility.hpp>
+
+namespace ulf::susiv2 {
+
+inline constexpr size_t answer_length_pos{0uz};
+inline constexpr size_t flags_pos{4uz};
+inline constexpr size_t header_size{5uz};
+
+/// Flags
+///
+/// The flags byte used to be a plain busy byte (0 or 1). Further flags are
+/// optional extensions which a receiver must explicitly support.
+inline constexpr uint8_t busy_flag{1u << 0u};       ///< Contains busy phase
+inline constexpr uint8_t compressed_flag{1u << 1u}; ///< Compressed ZppWrite
+inline constexpr uint8_t multi_flag{1u << 2u};      ///< Multiple packets
+inline constexpr uint8_t sequence_flag{1u << 3u};   ///< Sequence number
+
+/// Extended header
+///
+/// Frames with the sequence_flag set carry an additional sequence number
+/// directly after the header. Everything else is shifted by one byte.
+inline constexpr size_t sequence_pos{header_size};
+inline constexpr size_t sequence_header_size{header_size + 1uz};
+
+/// Helper to get the length of the expected answer from a SUSIV2 frame
+///
+/// \param  frame         SUSIV2 frame to search
+/// \retval uint32_t      Length of expected answer (not including ack/nak)
+/// \retval std::nullopt  Frame is too short to contain a header
+constexpr std::optional<uint32_t>
+get_answer_length(std::span<uint8_t const> frame) {
+  if (size(frame) < header_size) return std::nullopt;
+  return zusi::data2uint32(&frame[answer_length_pos]);
+}
+
+/// Helper to get the flags from a SUSIV2 frame
+///
+/// \param  frame         SUSIV2 frame to search
+/// \retval uint8_t       Flags
+/// \retval std::nullopt  Frame is too short to contain a header
+constexpr std::optional<uint8_t> get_flags(std::span<uint8_t const> frame) {
+  if (size(frame) < header_size) return std::nullopt;
+  return frame[flags_pos];
+}
+
+/// Helper to get the sequence number from a SUSIV2 frame
+///
+/// \param  frame         SUSIV2 frame to search
+/// \retval uint8_t       Sequence number
+/// \retval std::nullopt  Frame has no sequence number or is too short
+constexpr std::optional<uint8_t> get_sequence(std::span<uint8_t const> frame) {
+  if (size(frame) < sequence_header_size ||
+      !(frame[flags_pos] & sequence_flag))
+    return std::nullopt;
+  return frame[sequence_pos];
+}
+
+} // namespace ulf::susiv2
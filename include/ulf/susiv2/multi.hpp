@@ -0,0 +1,212 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Multi-packet frames
+///
+/// \file   ulf/susiv2/multi.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <ztl/inplace_vector.hpp>
+#include <zusi/zusi.hpp>
+#include "ack.hpp"
+#include "header.hpp"
+#include "nak.hpp"
+#include "utility.hpp"
+#include "validate.hpp"
+
+namespace ulf::susiv2 {
+
+/// Multi-packet frame
+///
+/// Frames with the multi_flag set carry a packet count followed by that many
+/// ZUSI packets.
+/// | header | count | packet 0 | packet 1 | ... |
+/// The answer length in the header is the sum of the answer lengths of all
+/// packets. The receiver answers with a single response which contains an
+/// ack/nak byte for each packet, each ack followed by the packets data and
+/// its CRC8 (if any).
+inline constexpr size_t multi_count_pos{header_size};
+inline constexpr size_t multi_header_size{header_size + 1uz};
+
+/// Aggregated response to a multi-packet frame
+using MultiResponse =
+  ztl::inplace_vector<uint8_t, ULF_SUSIV2_MAX_MULTI_RESPONSE_SIZE>;
+
+/// Frame and response size limits
+struct Limits {
+  size_t frame_size{ULF_SUSIV2_MAX_FRAME_SIZE};
+  size_t response_size{ULF_SUSIV2_MAX_MULTI_RESPONSE_SIZE};
+};
+
+/// Negotiate limits between transmitter and receiver
+///
+/// \param  lhs Limits of one side
+/// \param  rhs Limits of the other side
+/// \return Limits both sides support
+constexpr Limits negotiate(Limits lhs, Limits rhs) {
+  return {.frame_size = std::min(lhs.frame_size, rhs.frame_size),
+          .response_size = std::min(lhs.response_size, rhs.response_size)};
+}
+
+/// Helper to get the size of a multi-packet frame from its first bytes
+///
+/// \param  frame         Start of multi-packet SUSIV2 frame
+/// \retval size_t        Size of the complete frame
+/// \retval std::nullopt  Frame is too short to determine its size
+/// \retval std::errc     Unknown command or no packets
+constexpr std::expected<std::optional<size_t>, std::errc>
+get_multi_frame_size(std::span<uint8_t const> frame) {
+  if (size(frame) <= multi_count_pos) return std::nullopt;
+  if (!frame[multi_count_pos])
+    return std::unexpected{std::errc::protocol_error};
+  auto i{multi_header_size};
+  for (auto n{frame[multi_count_pos]}; n; --n) {
+    auto const packet_size{
+      get_packet_size(frame.subspan(std::min(i, size(frame))))};
+    if (!packet_size) return std::unexpected{packet_size.error()};
+    if (!*packet_size) return std::nullopt;
+    i += **packet_size;
+  }
+  return i;
+}
+
+/// Convert multi-packet frame to ZUSI packets
+///
+/// All packets are validated before the first one is passed on.
+///
+/// \tparam F             Callable taking a std::span<uint8_t const>
+/// \param  frame         Multi-packet SUSIV2 frame
+/// \param  f             Invoked with each packet
+/// \retval size_t        Number of packets
+/// \retval std::nullopt  Frame incomplete
+/// \retval std::errc     Frame corrupt or not a multi-packet frame
+template<std::invocable<std::span<uint8_t const>> F>
+constexpr std::expected<std::optional<size_t>, std::errc>
+frame2packets(std::span<uint8_t const> frame, F&& f) {
+  auto const flags{get_flags(frame)};
+  if (!flags) return std::nullopt;
+  if ((*flags & (multi_flag | compressed_flag)) != multi_flag)
+    return std::unexpected{std::errc::not_supported};
+  auto const frame_size{get_multi_frame_size(frame)};
+  if (!frame_size) return std::unexpected{frame_size.error()};
+  if (!*frame_size || size(frame) < **frame_size) return std::nullopt;
+
+  size_t const count{frame[multi_count_pos]};
+  for (auto pass{0uz}; pass < 2uz; ++pass) {
+    auto packets{frame.subspan(multi_header_size)};
+    for (auto i{0uz}; i < count; ++i) {
+      auto const packet{packets.first(**get_packet_size(packets))};
+      packets = packets.subspan(size(packet));
+      if (pass) std::invoke(f, packet);
+      else if (crc8_update(0u, packet))
+        return std::unexpected{std::errc::protocol_error};
+    }
+  }
+  return count;
+}
+
+/// Append ZUSI feedback to aggregated response
+///
+/// \param  resp  Aggregated response
+/// \param  fb    ZUSI feedback
+/// \retval true  Appended
+/// \retval false Response is full
+constexpr bool append_response(MultiResponse& resp, zusi::Feedback fb) {
+  auto const n{fb && size(*fb) ? 1uz + size(*fb) + 1uz : 1uz};
+  if (size(resp) + n > resp.capacity()) return false;
+  if (!fb) resp.push_back(nak);
+  else {
+    resp.push_back(ack);
+    if (size(*fb)) {
+      std::ranges::copy(*fb, std::back_inserter(resp));
+      resp.push_back(zusi::crc8(*fb));
+    }
+  }
+  return true;
+}
+
+/// Multi-packet frame builder
+///
+/// Packets are appended as long as both the frame and the expected response
+/// stay within the negotiated limits.
+class MultiFrame {
+public:
+  /// Ctor
+  ///
+  /// \param  limits  Negotiated limits
+  constexpr explicit MultiFrame(Limits limits = {})
+    : _limits{std::min(limits.frame_size, size_t{ULF_SUSIV2_MAX_FRAME_SIZE}),
+              std::min(limits.response_size,
+                       size_t{ULF_SUSIV2_MAX_MULTI_RESPONSE_SIZE})} {
+    clear();
+  }
+
+  /// Append packet
+  ///
+  /// \param  packet        Complete ZUSI packet
+  /// \param  answer_length Length of the expected answer data of this packet
+  ///                       (without ack and CRC8)
+  /// \param  busy          ZUSI command contains a busy phase
+  /// \retval true          Appended
+  /// \retval false         Frame or expected response would exceed limits
+  constexpr bool push_back(std::span<uint8_t const> packet,
+                           uint32_t answer_length,
+                           bool busy) {
+    // Ack, data and CRC8 if there is any data, see append_response
+    auto const response_size{1uz + answer_length + (answer_length ? 1uz : 0uz)};
+    if (_size + size(packet) > _limits.frame_size ||
+        _response_size + response_size > _limits.response_size ||
+        _buf[multi_count_pos] == UINT8_MAX)
+      return false;
+    std::ranges::copy(packet, begin(std::span{_buf}.subspan(_size)));
+    _size += size(packet);
+    _response_size += response_size;
+    _answer_length += answer_length;
+    ++_buf[multi_count_pos];
+    if (busy) _buf[flags_pos] |= busy_flag;
+    uint32_2data(_answer_length, &_buf[answer_length_pos]);
+    return true;
+  }
+
+  /// Number of packets
+  constexpr size_t count() const { return _buf[multi_count_pos]; }
+
+  /// Size of expected response if all packets are acknowledged
+  constexpr size_t response_size() const { return _response_size; }
+
+  /// Get frame
+  constexpr std::span<uint8_t const> frame() const {
+    return {cbegin(_buf), _size};
+  }
+
+  /// Remove all packets
+  constexpr void clear() {
+    std::ranges::fill(std::span{_buf}.first(multi_header_size), 0u);
+    _buf[flags_pos] = multi_flag;
+    _size = multi_header_size;
+    _response_size = 0uz;
+    _answer_length = 0u;
+  }
+
+private:
+  std::array<uint8_t, ULF_SUSIV2_MAX_FRAME_SIZE> _buf{};
+  Limits _limits{};
+  size_t _size{};
+  size_t _response_size{};
+  uint32_t _answer_length{};
+};
+
+} // namespace ulf::susiv2
@@ -0,0 +1,138 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Typed views on validated ZUSI packets
+///
+/// \file   ulf/susiv2/packet_view.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <utility>
+#include <zusi/command.hpp>
+#include <zusi/utility.hpp>
+
+namespace ulf::susiv2 {
+
+/// Typed views
+///
+/// Views don't check anything, they must only be created from packets which
+/// have already been validated (e.g. returned by frame2packet or Decoder).
+/// Field offsets are constants, so accessing a field is a plain load.
+struct CvReadView {
+  static constexpr auto command{zusi::Command::CvRead};
+  std::span<uint8_t const> packet;
+
+  /// Number of CVs - 1
+  constexpr uint8_t count() const { return packet[zusi::data_cnt_pos]; }
+
+  /// CV address
+  constexpr uint32_t address() const {
+    return zusi::data2uint32(&packet[zusi::addr_pos]);
+  }
+};
+
+struct CvWriteView {
+  static constexpr auto command{zusi::Command::CvWrite};
+  std::span<uint8_t const> packet;
+
+  /// Number of CVs - 1
+  constexpr uint8_t count() const { return packet[zusi::data_cnt_pos]; }
+
+  /// CV address
+  constexpr uint32_t address() const {
+    return zusi::data2uint32(&packet[zusi::addr_pos]);
+  }
+
+  /// CV values (count() + 1 bytes)
+  constexpr std::span<uint8_t const> data() const {
+    return packet.subspan(zusi::data_pos, count() + 1uz);
+  }
+};
+
+struct ZppEraseView {
+  static constexpr auto command{zusi::Command::ZppErase};
+  std::span<uint8_t const> packet;
+};
+
+struct ZppWriteView {
+  static constexpr auto command{zusi::Command::ZppWrite};
+  std::span<uint8_t const> packet;
+
+  /// Number of bytes - 1
+  constexpr uint8_t count() const { return packet[zusi::data_cnt_pos]; }
+
+  /// Flash address
+  constexpr uint32_t address() const {
+    return zusi::data2uint32(&packet[zusi::addr_pos]);
+  }
+
+  /// Flash data (count() + 1 bytes)
+  constexpr std::span<uint8_t const> data() const {
+    return packet.subspan(zusi::data_pos, count() + 1uz);
+  }
+};
+
+struct FeaturesView {
+  static constexpr auto command{zusi::Command::Features};
+  std::span<uint8_t const> packet;
+};
+
+struct ExitView {
+  static constexpr auto command{zusi::Command::Exit};
+  std::span<uint8_t const> packet;
+
+  /// Exit flags
+  constexpr uint8_t flags() const { return packet[zusi::exit_flags_pos]; }
+};
+
+struct ZppLcDcQueryView {
+  static constexpr auto command{zusi::Command::ZppLcDcQuery};
+  std::span<uint8_t const> packet;
+};
+
+/// Handler accepting every view
+template<typename F>
+concept PacketVisitor =
+  std::invocable<F, CvReadView> && std::invocable<F, CvWriteView> &&
+  std::invocable<F, ZppEraseView> && std::invocable<F, ZppWriteView> &&
+  std::invocable<F, FeaturesView> && std::invocable<F, ExitView> &&
+  std::invocable<F, ZppLcDcQueryView>;
+
+/// Invoke handler with the view matching the command of a packet
+///
+/// The packet must have been validated (e.g. returned by frame2packet or
+/// Decoder), the command is not checked again.
+///
+/// \tparam F       Handler, usually an overload set of lambdas
+/// \param  f       Handler
+/// \param  packet  Validated ZUSI packet
+/// \return Whatever f returns
+template<PacketVisitor F>
+constexpr decltype(auto) visit_packet(F&& f, std::span<uint8_t const> packet) {
+  switch (static_cast<zusi::Command>(packet[zusi::cmd_pos])) {
+    case zusi::Command::CvRead:
+      return std::invoke(std::forward<F>(f), CvReadView{packet});
+    case zusi::Command::CvWrite:
+      return std::invoke(std::forward<F>(f), CvWriteView{packet});
+    case zusi::Command::ZppErase:
+      return std::invoke(std::forward<F>(f), ZppEraseView{packet});
+    case zusi::Command::ZppWrite:
+      return std::invoke(std::forward<F>(f), ZppWriteView{packet});
+    case zusi::Command::Features:
+      return std::invoke(std::forward<F>(f), FeaturesView{packet});
+    case zusi::Command::Exit:
+      return std::invoke(std::forward<F>(f), ExitView{packet});
+    case zusi::Command::ZppLcDcQuery:
+      return std::invoke(std::forward<F>(f), ZppLcDcQueryView{packet});
+    default: std::unreachable();
+  }
+}
+
+} // namespace ulf::susiv2
@@ -0,0 +1,208 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Range adaptor yielding packets from a byte source
+///
+/// \file   ulf/susiv2/packets_view.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <expected>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include "decoder.hpp"
+
+#if __has_include(<generator>)
+#  include <generator>
+#endif
+
+namespace ulf::susiv2 {
+
+namespace detail {
+
+/// Range of bytes which can be handed to the decoder as a single chunk
+template<typename V>
+concept contiguous_bytes =
+  std::ranges::contiguous_range<V> && std::ranges::sized_range<V> &&
+  std::same_as<std::ranges::range_value_t<V>, uint8_t>;
+
+/// Range of chunks (e.g. std::span or std::vector of bytes)
+template<typename V>
+concept chunk_source =
+  std::convertible_to<std::ranges::range_reference_t<V>,
+                      std::span<uint8_t const>> &&
+  (std::is_reference_v<std::ranges::range_reference_t<V>> ||
+   std::ranges::borrowed_range<std::ranges::range_reference_t<V>>);
+
+/// Range of single bytes
+template<typename V>
+concept byte_source =
+  std::convertible_to<std::ranges::range_reference_t<V>, uint8_t>;
+
+} // namespace detail
+
+/// View yielding packets from a byte source
+///
+/// The underlying range is pulled lazily, either byte by byte or chunk by
+/// chunk, and fed to a Decoder. Elements are packets or the errors of corrupt
+/// frames, a corrupt frame doesn't end the view. Packets are views into the
+/// decoder and stay valid until the iterator is incremented. A partial frame
+/// at the end of the underlying range is dropped.
+///
+/// \tparam V Input view of bytes or chunks of bytes
+template<std::ranges::input_range V>
+requires std::ranges::view<V> &&
+         (detail::chunk_source<V> || detail::byte_source<V>)
+class packets_view : public std::ranges::view_interface<packets_view<V>> {
+public:
+  using value_type = std::expected<std::span<uint8_t const>, std::errc>;
+
+  constexpr packets_view()
+  requires std::default_initializable<V>
+  = default;
+  constexpr explicit packets_view(V base) : _base{std::move(base)} {}
+
+  /// Underlying view
+  constexpr V base() const&
+  requires std::copy_constructible<V>
+  {
+    return _base;
+  }
+  constexpr V base() && { return std::move(_base); }
+
+  constexpr auto begin() {
+    _it = std::ranges::begin(_base);
+    if constexpr (detail::contiguous_bytes<V>) {
+      _chunk = {std::ranges::data(_base), std::ranges::size(_base)};
+      _it = std::ranges::end(_base);
+    }
+    next();
+    return iterator{this};
+  }
+
+  constexpr std::default_sentinel_t end() const { return {}; }
+
+private:
+  class iterator {
+  public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type = packets_view::value_type;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr iterator() = default;
+    constexpr explicit iterator(packets_view* parent) : _parent{parent} {}
+
+    constexpr value_type const& operator*() const { return _parent->_value; }
+
+    constexpr iterator& operator++() {
+      _parent->next();
+      return *this;
+    }
+    constexpr void operator++(int) { ++*this; }
+
+    friend constexpr bool operator==(iterator const& it,
+                                     std::default_sentinel_t) {
+      return it.done();
+    }
+
+  private:
+    constexpr bool done() const { return _parent->_end; }
+
+    packets_view* _parent{};
+  };
+
+  /// Decode until the next packet or error or until the input runs dry
+  constexpr void next() {
+    for (;;) {
+      auto const packet{_decoder.receive(_chunk, 0u)};
+      if (!packet) {
+        _value = std::unexpected{packet.error()};
+        return;
+      } else if (*packet) {
+        _value = **packet;
+        return;
+      } else if (!pull()) {
+        _end = true;
+        return;
+      }
+    }
+  }
+
+  /// Get the next chunk or byte from the underlying range
+  constexpr bool pull() {
+    if constexpr (detail::contiguous_bytes<V>) return false;
+    else if constexpr (detail::chunk_source<V>) {
+      // Chunk must stay alive while it's consumed, advance lazily
+      if (_pulled) ++_it;
+      if (_it == std::ranges::end(_base)) return false;
+      _chunk = *_it;
+      _pulled = true;
+      return true;
+    } else {
+      if (_it == std::ranges::end(_base)) return false;
+      _byte = static_cast<uint8_t>(*_it);
+      ++_it;
+      _chunk = {&_byte, 1uz};
+      return true;
+    }
+  }
+
+  V _base{};
+  std::ranges::iterator_t<V> _it{};
+  Decoder _decoder{};
+  std::span<uint8_t const> _chunk{};
+  value_type _value{};
+  uint8_t _byte{};
+  bool _pulled{};
+  bool _end{};
+};
+
+template<typename R>
+packets_view(R&&) -> packets_view<std::views::all_t<R>>;
+
+namespace views {
+
+/// Range adaptor object for packets_view
+struct packets_fn {
+  template<std::ranges::viewable_range R>
+  constexpr auto operator()(R&& r) const {
+    return packets_view{std::forward<R>(r)};
+  }
+
+  template<std::ranges::viewable_range R>
+  friend constexpr auto operator|(R&& r, packets_fn const& f) {
+    return f(std::forward<R>(r));
+  }
+};
+
+/// bytes | ulf::susiv2::views::packets
+inline constexpr packets_fn packets{};
+
+} // namespace views
+
+#if defined(__cpp_lib_generator) && __cpp_lib_generator >= 202207L
+/// Coroutine yielding packets from a byte source
+///
+/// Same as views::packets, for pipelines which are built from generators.
+///
+/// \tparam R Input range of bytes or chunks of bytes
+/// \param  r Byte source
+/// \return Generator yielding packets or the errors of corrupt frames
+template<std::ranges::input_range R>
+std::generator<std::expected<std::span<uint8_t const>, std::errc>>
+packet_generator(R r) {
+  for (auto const& packet : views::packets(r)) co_yield packet;
+}
+#endif
+
+} // namespace ulf::susiv2
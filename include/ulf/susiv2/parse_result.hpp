@@ -0,0 +1,114 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Flat parse results
+///
+/// \file   ulf/susiv2/parse_result.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <type_traits>
+
+namespace ulf::susiv2 {
+
+/// Status of a parse result
+enum class Status : uint8_t {
+  Ok,             ///< Value is valid
+  Incomplete,     ///< More bytes needed
+  Corrupt,        ///< Checksum mismatch or trailing bytes
+  UnknownCommand, ///< Unknown command or command without the requested field
+  BadHeader,      ///< Frame is compressed, multi-packet or sequenced
+};
+
+/// Convert status to the error of the nested API
+///
+/// \param  status  Status other than Ok or Incomplete
+/// \return Error the nested API reports in this case
+constexpr std::errc to_errc(Status status) {
+  return status == Status::BadHeader ? std::errc::not_supported
+                                     : std::errc::protocol_error;
+}
+
+/// Flat parse result
+///
+/// Alternative to std::expected<std::optional<T>, std::errc> with a single
+/// status byte instead of two nested discriminators. The value is only
+/// meaningful if the status is Ok.
+///
+/// Results are trivially copyable. On 64 bit ABIs all of them are returned in
+/// registers. AAPCS (Cortex-M) only returns composites of at most 4 bytes in
+/// r0, that is ParseResult<uint8_t>, ParseResult<uint16_t> and
+/// ParseResult<zusi::Command>. Larger results such as ParseResult<uint32_t> or
+/// the packet result are returned through memory there.
+///
+/// \tparam T Value type
+template<typename T>
+class ParseResult {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  using value_type = T;
+
+  constexpr ParseResult(Status status) : _status{status} {}
+  constexpr ParseResult(T value) : _value{value}, _status{Status::Ok} {}
+
+  constexpr Status status() const { return _status; }
+  constexpr T value() const { return _value; }
+  constexpr T operator*() const { return _value; }
+  constexpr explicit operator bool() const { return _status == Status::Ok; }
+
+private:
+  T _value{};
+  Status _status;
+};
+
+/// Flat parse result of a packet
+///
+/// Stores the size of the span as 16 bit value, so that the result fits into
+/// two registers on 64 bit ABIs.
+template<>
+class ParseResult<std::span<uint8_t const>> {
+public:
+  using value_type = std::span<uint8_t const>;
+
+  constexpr ParseResult(Status status) : _status{status} {}
+  constexpr ParseResult(value_type value)
+    : _data{data(value)}, _size{static_cast<uint16_t>(size(value))},
+      _status{Status::Ok} {}
+
+  constexpr Status status() const { return _status; }
+  constexpr value_type value() const { return {_data, _size}; }
+  constexpr value_type operator*() const { return value(); }
+  constexpr explicit operator bool() const { return _status == Status::Ok; }
+
+private:
+  uint8_t const* _data{};
+  uint16_t _size{};
+  Status _status;
+};
+
+/// Convert flat parse result to the result of the nested API
+///
+/// \tparam U       Value type of the nested result
+/// \tparam T       Value type of the flat result
+/// \param  result  Flat parse result
+/// \retval U       Value
+/// \retval std::nullopt  Status::Incomplete
+/// \retval std::errc     Any other status, see to_errc
+template<typename U, typename T>
+constexpr std::expected<std::optional<U>, std::errc>
+to_expected(ParseResult<T> result) {
+  if (result) return static_cast<U>(*result);
+  if (result.status() == Status::Incomplete) return std::nullopt;
+  return std::unexpected{to_errc(result.status())};
+}
+
+} // namespace ulf::susiv2
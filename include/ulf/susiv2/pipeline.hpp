@@ -0,0 +1,280 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Sliding-window pipelining
+///
+/// \file   ulf/susiv2/pipeline.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <utility>
+#include <ztl/inplace_vector.hpp>
+#include <zusi/zusi.hpp>
+#include "ack.hpp"
+#include "crc8.hpp"
+#include "header.hpp"
+#include "nak.hpp"
+
+namespace ulf::susiv2 {
+
+/// Response to a sequenced frame
+///
+/// | sequence | ack/nak | data | crc8 |
+using SequencedResponse =
+  ztl::inplace_vector<uint8_t, 1uz + ULF_SUSIV2_MAX_RESPONSE_SIZE>;
+
+/// Largest number of frames in flight
+///
+/// Half the sequence number space, so that a late response can never be
+/// mistaken for one of the current window.
+inline constexpr size_t max_window_size{128uz};
+
+/// Convert ZUSI feedback to response to a sequenced frame
+///
+/// \param  fb        ZUSI feedback
+/// \param  sequence  Sequence number of the frame
+/// \return Response
+constexpr SequencedResponse feedback2response(zusi::Feedback fb,
+                                              uint8_t sequence) {
+  if (!fb) return {sequence, nak};
+  SequencedResponse resp{sequence, ack};
+  if (size(*fb)) {
+    std::ranges::copy(*fb, std::back_inserter(resp));
+    resp.push_back(zusi::crc8(*fb));
+  }
+  return resp;
+}
+
+/// Insert sequence number into frame
+///
+/// \param  frame     SUSIV2 frame without sequence number
+/// \param  sequence  Sequence number
+/// \param  out       Buffer of at least size(frame) + 1 bytes
+/// \return View on sequenced frame
+constexpr std::span<uint8_t const> add_sequence(std::span<uint8_t const> frame,
+                                                uint8_t sequence,
+                                                std::span<uint8_t> out) {
+  auto it{std::ranges::copy(frame.first(header_size), begin(out)).out};
+  *it++ = sequence;
+  std::ranges::copy(frame.subspan(header_size), it);
+  out[flags_pos] |= sequence_flag;
+  return out.first(size(frame) + 1uz);
+}
+
+/// Response to a frame of the window
+struct Reply {
+  uint8_t sequence{};
+  bool ack{};
+  std::span<uint8_t const> data{}; ///< Without CRC8
+};
+
+/// Host side of a sliding window
+///
+/// Keeps track of up to window() sequenced frames in flight and matches the
+/// incoming responses against them. The receiver answers frames strictly in
+/// the order it received them, so responses are expected in the order the
+/// frames were sent. A missing response (lost or corrupt frame) shows up as a
+/// response with an unexpected sequence number or as a timeout. Either way the
+/// host has to rewind() and retransmit every frame in flight (go-back-N).
+/// Rewinding is best done once the line is idle, since responses which are
+/// still underway would otherwise trigger another rewind.
+///
+/// Retransmitted frames keep their sequence numbers, so that a receiver using
+/// a Sequencer executes each frame exactly once and in order. Responses to
+/// frames which have already been answered are silently skipped. Without a
+/// Sequencer the receiver executes frames following the lost one twice.
+/// Executing CvRead, CvWrite or ZppWrite twice is harmless, but not every ZUSI
+/// command is idempotent. A repeated ZppErase after later ZppWrites destroys
+/// their data and a repeated Exit is never answered. Frames with such commands
+/// have to be pushed as exclusive, which only succeeds once all other frames
+/// have been answered and keeps further frames out of the window until it has
+/// been answered itself.
+///
+/// Only single-packet frames are supported.
+class Window {
+public:
+  using result_type = std::expected<std::optional<Reply>, std::errc>;
+
+  /// Ctor
+  ///
+  /// \param  window  Number of frames in flight (1 is stop-and-wait)
+  constexpr explicit Window(size_t window = 8uz)
+    : _window{std::clamp(window, 1uz, max_window_size)} {}
+
+  /// Reserve sequence number for the next frame
+  ///
+  /// \param  answer_length Length of the expected answer
+  /// \param  exclusive     Frame must not share the window with others (e.g.
+  ///                       ZppErase or Exit)
+  /// \retval uint8_t       Sequence number of the frame
+  /// \retval std::nullopt  Window is full or other frames are still in flight
+  ///                       for an exclusive frame
+  constexpr std::optional<uint8_t> push(uint32_t answer_length,
+                                        bool exclusive = false) {
+    if (full() || (exclusive && _in_flight)) return std::nullopt;
+    auto const sequence{static_cast<uint8_t>(_oldest + _in_flight++)};
+    _answer_lengths[sequence] = answer_length;
+    _exclusive = exclusive;
+    return sequence;
+  }
+
+  /// Receive chunk of responses
+  ///
+  /// \param[in,out]  chunk         Received bytes, contains the bytes not yet
+  ///                               consumed on return
+  /// \retval         Reply         Response to the oldest frame in flight,
+  ///                               valid until next call
+  /// \retval         std::nullopt  Response incomplete
+  /// \retval         std::errc     Unexpected or corrupt response, the rest
+  ///                               of the chunk is discarded
+  constexpr result_type receive(std::span<uint8_t const>& chunk) {
+    if (_done) {
+      _buf.clear();
+      _done = false;
+    }
+
+    while (!empty(chunk)) {
+      _buf.push_back(chunk.front());
+      chunk = chunk.subspan(1uz);
+
+      // Response to oldest frame or to a frame which has been rewound?
+      auto const sequence{_buf[0uz]};
+      auto const stale{!_in_flight || sequence != _oldest};
+      auto const age{static_cast<uint8_t>(_oldest - sequence)};
+      if (stale && age > max_window_size)
+        return std::unexpected{discard(chunk)};
+      if (size(_buf) < 2uz) continue;
+      if (_buf[1uz] != ack && _buf[1uz] != nak)
+        return std::unexpected{discard(chunk)};
+
+      // Complete?
+      auto const data_size{_buf[1uz] == ack ? _answer_lengths[sequence] : 0u};
+      auto const resp_size{2uz + data_size + (data_size ? 1uz : 0uz)};
+      if (resp_size > _buf.capacity()) return std::unexpected{discard(chunk)};
+      if (size(_buf) < resp_size) continue;
+      auto const data{std::span<uint8_t const>{_buf}.subspan(2uz, data_size)};
+      if (data_size && zusi::crc8(data) != _buf.back())
+        return std::unexpected{discard(chunk)};
+      if (stale) {
+        _buf.clear();
+        continue;
+      }
+      _done = true;
+      _exclusive = false;
+      ++_oldest;
+      --_in_flight;
+      return Reply{.sequence = sequence, .ack = _buf[1uz] == ack, .data = data};
+    }
+
+    return std::nullopt;
+  }
+
+  /// Receive chunk of responses
+  ///
+  /// \param  chunk         Received bytes
+  /// \retval Reply         Response to the oldest frame in flight, valid until
+  ///                       next call
+  /// \retval std::nullopt  Response incomplete
+  /// \retval std::errc     Unexpected or corrupt response
+  constexpr result_type receive(std::span<uint8_t const>&& chunk) {
+    return receive(chunk);
+  }
+
+  /// Forget all frames in flight
+  ///
+  /// The frames have to be retransmitted in the same order, push() hands out
+  /// the same sequence numbers for them again.
+  ///
+  /// \return Number of frames to retransmit
+  constexpr size_t rewind() {
+    _buf.clear();
+    _done = false;
+    _exclusive = false;
+    return std::exchange(_in_flight, 0uz);
+  }
+
+  /// Sequence number of the oldest frame in flight (or the next one)
+  constexpr uint8_t oldest() const { return _oldest; }
+
+  /// Number of frames in flight
+  constexpr size_t in_flight() const { return _in_flight; }
+
+  /// Window is full or an exclusive frame is in flight
+  constexpr bool full() const { return _in_flight >= _window || _exclusive; }
+
+  /// Window size
+  constexpr size_t window() const { return _window; }
+
+private:
+  constexpr std::errc discard(std::span<uint8_t const>& chunk) {
+    _buf.clear();
+    chunk = {};
+    return std::errc::protocol_error;
+  }
+
+  std::array<uint32_t, 256uz> _answer_lengths{};
+  SequencedResponse _buf{};
+  size_t _window{};
+  size_t _in_flight{};
+  uint8_t _oldest{};
+  bool _done{};
+  bool _exclusive{};
+};
+
+/// Position of a sequenced frame relative to the expected one
+enum class Order : uint8_t {
+  Next,      ///< Expected frame, execute and respond
+  Gap,       ///< Preceding frame missing, drop without response
+  Duplicate, ///< Executed before, respond with nak instead of executing again
+};
+
+/// Receiver side of a sliding window
+///
+/// A lost or corrupt frame leaves a gap in the sequence numbers. Executing the
+/// frames following it would execute them out of order and, once the host has
+/// rewound, a second time. Therefore only the expected frame is let through.
+/// Frames following a gap are dropped without a response, the host runs into a
+/// timeout and retransmits them with the same sequence numbers. Frames which
+/// have been executed before (their response got lost) are answered with a nak
+/// and not executed again.
+///
+/// Like Window the sequence numbers start at 0, call reset() whenever the host
+/// starts a new Window.
+class Sequencer {
+public:
+  /// Check sequence number of a received frame
+  ///
+  /// \param  sequence  Sequence number of the frame
+  /// \return Order of the frame, only Order::Next advances the expected
+  ///         sequence number
+  constexpr Order receive(uint8_t sequence) {
+    auto const distance{static_cast<uint8_t>(sequence - _expected)};
+    if (!distance) {
+      ++_expected;
+      return Order::Next;
+    }
+    return distance < max_window_size ? Order::Gap : Order::Duplicate;
+  }
+
+  /// Sequence number of the next frame to execute
+  constexpr uint8_t expected() const { return _expected; }
+
+  /// Expect sequence number 0 again
+  constexpr void reset() { _expected = 0u; }
+
+private:
+  uint8_t _expected{};
+};
+
+} // namespace ulf::susiv2
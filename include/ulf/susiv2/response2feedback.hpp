@@ -0,0 +1,146 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Convert response to ZUSI feedback
+///
+/// \file   ulf/susiv2/response2feedback.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <expected>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <system_error>
+#include "ack.hpp"
+#include "crc8.hpp"
+#include "header.hpp"
+#include "nak.hpp"
+#include "response.hpp"
+
+namespace ulf::susiv2 {
+
+/// Convert response to ZUSI feedback
+///
+/// The CRC8 is checked in the same pass which finds the data, nothing is
+/// copied.
+///
+/// \param  resp          Response
+/// \param  answer_length Length of the expected answer
+/// \retval std::span     View on data (without CRC8)
+/// \retval std::nullopt  Response incomplete
+/// \retval std::errc     Response is a nak (std::errc::io_error) or corrupt
+constexpr std::expected<std::optional<std::span<uint8_t const>>, std::errc>
+response2feedback(std::span<uint8_t const> resp, uint32_t answer_length) {
+  if (empty(resp)) return std::nullopt;
+  if (resp[0uz] == nak) return std::unexpected{std::errc::io_error};
+  if (resp[0uz] != ack) return std::unexpected{std::errc::protocol_error};
+  if (!answer_length) return resp.subspan(1uz, 0uz);
+  if (size(resp) < 1uz + answer_length + 1uz) return std::nullopt;
+  // CRC8 over data including its checksum is 0
+  if (crc8_update(0u, resp.subspan(1uz, answer_length + 1uz)))
+    return std::unexpected{std::errc::protocol_error};
+  return resp.subspan(1uz, answer_length);
+}
+
+/// Convert response to ZUSI feedback
+///
+/// \param  resp          Response
+/// \param  frame         SUSIV2 frame the response belongs to
+/// \retval std::span     View on data (without CRC8)
+/// \retval std::nullopt  Response incomplete
+/// \retval std::errc     Response is a nak (std::errc::io_error) or corrupt
+constexpr std::expected<std::optional<std::span<uint8_t const>>, std::errc>
+response2feedback(std::span<uint8_t const> resp,
+                  std::span<uint8_t const> frame) {
+  auto const answer_length{get_answer_length(frame)};
+  if (!answer_length) return std::unexpected{std::errc::invalid_argument};
+  return response2feedback(resp, *answer_length);
+}
+
+/// Incremental response decoder
+///
+/// Collects chunks of a byte stream until a complete response is received.
+/// The CRC8 is updated while the bytes are copied, so completing a response
+/// doesn't need another pass over the data.
+class ResponseDecoder {
+public:
+  using result_type =
+    std::expected<std::optional<std::span<uint8_t const>>, std::errc>;
+
+  /// Ctor
+  ///
+  /// \param  answer_length Length of the expected answer
+  constexpr explicit ResponseDecoder(uint32_t answer_length = 0u) {
+    expect(answer_length);
+  }
+
+  /// Start next response
+  ///
+  /// \param  answer_length Length of the expected answer
+  constexpr void expect(uint32_t answer_length) {
+    _buf.clear();
+    _answer_length = answer_length;
+    _crc = 0u;
+  }
+
+  /// Receive chunk
+  ///
+  /// \param[in,out]  chunk         Received bytes, contains the bytes not yet
+  ///                               consumed on return
+  /// \retval         std::span     View on data (without CRC8), valid until
+  ///                               next call to expect
+  /// \retval         std::nullopt  Response incomplete
+  /// \retval         std::errc     Response is a nak (std::errc::io_error) or
+  ///                               corrupt
+  constexpr result_type receive(std::span<uint8_t const>& chunk) {
+    // Ack/nak
+    if (!size(_buf)) {
+      if (empty(chunk)) return std::nullopt;
+      _buf.push_back(chunk.front());
+      chunk = chunk.subspan(1uz);
+    }
+    if (_buf[0uz] == nak) return std::unexpected{std::errc::io_error};
+    if (_buf[0uz] != ack) return std::unexpected{std::errc::protocol_error};
+    if (!_answer_length)
+      return std::span<uint8_t const>{_buf}.subspan(1uz, 0uz);
+    if (1uz + _answer_length + 1uz > _buf.capacity())
+      return std::unexpected{std::errc::message_size};
+
+    // Data and CRC8
+    auto const n{std::min(1uz + _answer_length + 1uz - size(_buf),
+                          size(chunk))};
+    _crc = crc8_update(_crc, chunk.first(n));
+    std::ranges::copy(chunk.first(n), std::back_inserter(_buf));
+    chunk = chunk.subspan(n);
+    if (size(_buf) < 1uz + _answer_length + 1uz) return std::nullopt;
+    if (_crc) return std::unexpected{std::errc::protocol_error};
+    return std::span<uint8_t const>{_buf}.subspan(1uz, _answer_length);
+  }
+
+  /// Receive chunk
+  ///
+  /// \param  chunk         Received bytes
+  /// \retval std::span     View on data (without CRC8), valid until next call
+  ///                       to expect
+  /// \retval std::nullopt  Response incomplete
+  /// \retval std::errc     Response is a nak (std::errc::io_error) or corrupt
+  constexpr result_type receive(std::span<uint8_t const>&& chunk) {
+    return receive(chunk);
+  }
+
+  /// Number of bytes received so far
+  constexpr size_t pending() const { return size(_buf); }
+
+private:
+  Response _buf{};
+  uint32_t _answer_length{};
+  uint8_t _crc{};
+};
+
+} // namespace ulf::susiv2
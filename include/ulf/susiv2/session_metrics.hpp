@@ -0,0 +1,350 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Update session metrics
+///
+/// Host only, this header relies on lock-free 64 bit atomics and is therefore
+/// not included by ulf/susiv2.hpp.
+///
+/// \file   ulf/susiv2/session_metrics.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <zusi/command.hpp>
+
+namespace ulf::susiv2 {
+
+/// Upper bounds of the RTT histogram buckets [µs]
+inline constexpr std::array<uint32_t, 12uz> rtt_buckets{
+  100u, 250u, 500u, 1'000u, 2'000u, 5'000u,
+  10'000u, 20'000u, 50'000u, 100'000u, 200'000u, 500'000u};
+
+/// Commands are counted by value, larger values share the last slot
+inline constexpr size_t metrics_commands{16uz};
+
+/// One frame and its response
+struct FrameMetrics {
+  zusi::Command cmd{};  ///< Command (of the first packet)
+  bool ack{};           ///< Response was an ack
+  uint32_t bytes{};     ///< Frame and response size
+  uint32_t rtt{};       ///< Round-trip time [µs]
+  uint32_t busy{};      ///< Part of the round-trip the receiver was busy [µs]
+  uint32_t progress{};  ///< Progress made, e.g. ZppWrite data bytes
+};
+
+/// Snapshot of a session
+struct SessionSnapshot {
+  uint64_t elapsed{};  ///< Time since start [µs]
+  uint64_t total{};    ///< Expected progress (0 if unknown)
+  uint64_t progress{}; ///< Progress made
+  uint64_t bytes{};    ///< Frame and response bytes
+  uint64_t frames{};   ///< Frames answered
+  uint64_t busy{};     ///< Time the receiver was busy [µs]
+  uint64_t rtt_sum{};  ///< Sum of round-trip times [µs]
+  std::array<uint64_t, size(rtt_buckets) + 1uz> rtt{}; ///< Per bucket, the
+                                                        ///< last one unbounded
+  std::array<uint64_t, metrics_commands> acks{}; ///< Per command
+  std::array<uint64_t, metrics_commands> naks{}; ///< Per command
+
+  /// Average bytes per second
+  constexpr double bytes_per_second() const { return per_second(bytes); }
+
+  /// Average frames per second
+  constexpr double frames_per_second() const { return per_second(frames); }
+
+  /// Estimated time until total progress is made
+  ///
+  /// \retval uint64_t      Time [µs]
+  /// \retval std::nullopt  Total progress or rate unknown
+  constexpr std::optional<uint64_t> eta() const {
+    if (!total || !progress || !elapsed) return std::nullopt;
+    if (progress >= total) return 0u;
+    return static_cast<uint64_t>(static_cast<double>(total - progress) *
+                                 static_cast<double>(elapsed) /
+                                 static_cast<double>(progress));
+  }
+
+private:
+  constexpr double per_second(uint64_t n) const {
+    return elapsed ? static_cast<double>(n) * 1e6 /
+                       static_cast<double>(elapsed)
+                   : 0.0;
+  }
+};
+
+/// Live metrics of an update session
+///
+/// The session records frames from one thread, any other thread (or process)
+/// can take snapshots at any time. Records are guarded by a sequence lock, so
+/// recording never waits and a snapshot is always consistent (e.g. frames is
+/// the sum of all acks and naks). A snapshot only retries while a record is
+/// in progress.
+///
+/// All members are lock-free atomics without pointers. The class can
+/// therefore be constructed in a shared-memory segment and read by a
+/// monitoring process.
+class SessionMetrics {
+public:
+  /// Start (or restart) session
+  ///
+  /// \param  now   Monotonic timestamp [µs]
+  /// \param  total Expected progress, e.g. image size (0 if unknown)
+  void start(uint64_t now, uint64_t total = 0u) {
+    begin_record();
+    store(_start, now);
+    store(_total, total);
+    for (auto* a : {&_progress, &_bytes, &_frames, &_busy, &_rtt_sum})
+      store(*a, 0u);
+    for (auto& a : _rtt) store(a, 0u);
+    for (auto& a : _acks) store(a, 0u);
+    for (auto& a : _naks) store(a, 0u);
+    end_record();
+  }
+
+  /// Record frame
+  ///
+  /// \param  m Frame metrics
+  void record(FrameMetrics const& m) {
+    auto const cmd{std::min<size_t>(std::to_underlying(m.cmd),
+                                    metrics_commands - 1uz)};
+    auto const bucket{static_cast<size_t>(
+      std::ranges::lower_bound(rtt_buckets, m.rtt) - cbegin(rtt_buckets))};
+    begin_record();
+    add(_progress, m.progress);
+    add(_bytes, m.bytes);
+    add(_frames, 1u);
+    add(_busy, m.busy);
+    add(_rtt_sum, m.rtt);
+    add(_rtt[bucket], 1u);
+    add(m.ack ? _acks[cmd] : _naks[cmd], 1u);
+    end_record();
+  }
+
+  /// Take snapshot
+  ///
+  /// \param  now Monotonic timestamp [µs]
+  /// \return Snapshot
+  SessionSnapshot snapshot(uint64_t now) const {
+    SessionSnapshot s;
+    for (;;) {
+      auto const seq{_seq.load(std::memory_order_acquire)};
+      if (seq & 1u) continue;
+      s.elapsed = now - load(_start);
+      s.total = load(_total);
+      s.progress = load(_progress);
+      s.bytes = load(_bytes);
+      s.frames = load(_frames);
+      s.busy = load(_busy);
+      s.rtt_sum = load(_rtt_sum);
+      std::ranges::transform(_rtt, begin(s.rtt), load);
+      std::ranges::transform(_acks, begin(s.acks), load);
+      std::ranges::transform(_naks, begin(s.naks), load);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq.load(std::memory_order_relaxed) == seq) return s;
+    }
+  }
+
+private:
+  using counter_type = std::atomic<uint64_t>;
+  static_assert(counter_type::is_always_lock_free);
+
+  void begin_record() {
+    _seq.store(_seq.load(std::memory_order_relaxed) + 1u,
+               std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void end_record() {
+    _seq.store(_seq.load(std::memory_order_relaxed) + 1u,
+               std::memory_order_release);
+  }
+
+  static void store(counter_type& a, uint64_t value) {
+    a.store(value, std::memory_order_relaxed);
+  }
+
+  static void add(counter_type& a, uint64_t value) {
+    store(a, load(a) + value);
+  }
+
+  static uint64_t load(counter_type const& a) {
+    return a.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> _seq{};
+  counter_type _start{};
+  counter_type _total{};
+  counter_type _progress{};
+  counter_type _bytes{};
+  counter_type _frames{};
+  counter_type _busy{};
+  counter_type _rtt_sum{};
+  std::array<counter_type, size(rtt_buckets) + 1uz> _rtt{};
+  std::array<counter_type, metrics_commands> _acks{};
+  std::array<counter_type, metrics_commands> _naks{};
+};
+
+namespace detail {
+
+/// Name of a command slot, empty if unknown
+constexpr std::string_view command_name(size_t cmd) {
+  switch (static_cast<zusi::Command>(cmd)) {
+    case zusi::Command::CvRead: return "CvRead";
+    case zusi::Command::CvWrite: return "CvWrite";
+    case zusi::Command::ZppErase: return "ZppErase";
+    case zusi::Command::ZppWrite: return "ZppWrite";
+    case zusi::Command::Features: return "Features";
+    case zusi::Command::Exit: return "Exit";
+    case zusi::Command::ZppLcDcQuery: return "ZppLcDcQuery";
+    default: return {};
+  }
+}
+
+} // namespace detail
+
+/// Write snapshot in Prometheus text format
+///
+/// Nothing is allocated, the text is passed to f in pieces. Writing it to a
+/// temporary file which is then renamed makes it suitable for the textfile
+/// collector of the node exporter.
+///
+/// \tparam F       Callable taking a std::string_view
+/// \param  s       Snapshot
+/// \param  f       Invoked with consecutive pieces of text
+/// \param  labels  Labels added to every sample (e.g. station="7")
+template<std::invocable<std::string_view> F>
+void write_prometheus(SessionSnapshot const& s,
+                      F&& f,
+                      std::string_view labels = {}) {
+  using namespace std::string_view_literals;
+  // Numbers are formatted into a buffer owned by the caller, floating point
+  // ones in fixed notation
+  auto const chars{[](auto value, std::span<char> buf) {
+    auto const last{data(buf) + size(buf)};
+    if constexpr (std::floating_point<decltype(value)>)
+      return std::string_view{
+        data(buf),
+        std::to_chars(data(buf), last, value, std::chars_format::fixed).ptr};
+    else
+      return std::string_view{data(buf),
+                              std::to_chars(data(buf), last, value).ptr};
+  }};
+  auto const number{[&](auto value) {
+    std::array<char, 32uz> buf;
+    std::invoke(f, chars(value, buf));
+  }};
+  auto const header{[&](std::string_view name,
+                        std::string_view type,
+                        std::string_view help) {
+    for (auto const str : {"# HELP ulf_susiv2_"sv, name, " "sv, help,
+                           "\n# TYPE ulf_susiv2_"sv, name, " "sv, type,
+                           "\n"sv})
+      std::invoke(f, str);
+  }};
+  // Sample name and labels, the value is written by the caller
+  auto const sample{[&](std::string_view name,
+                        std::initializer_list<std::string_view> label = {}) {
+    std::invoke(f, "ulf_susiv2_"sv);
+    std::invoke(f, name);
+    if (!empty(labels) || size(label)) {
+      std::invoke(f, "{"sv);
+      std::invoke(f, labels);
+      if (!empty(labels) && size(label)) std::invoke(f, ","sv);
+      for (auto const str : label) std::invoke(f, str);
+      std::invoke(f, "}"sv);
+    }
+    std::invoke(f, " "sv);
+  }};
+  auto const metric{[&](std::string_view name,
+                        std::string_view type,
+                        std::string_view help,
+                        auto value) {
+    header(name, type, help);
+    sample(name);
+    number(value);
+    std::invoke(f, "\n"sv);
+  }};
+
+  metric("elapsed_seconds",
+         "gauge",
+         "Time since start of session",
+         static_cast<double>(s.elapsed) / 1e6);
+  metric("bytes_total", "counter", "Frame and response bytes", s.bytes);
+  metric("frames_total", "counter", "Frames answered", s.frames);
+  metric("busy_seconds_total",
+         "counter",
+         "Time the receiver was busy",
+         static_cast<double>(s.busy) / 1e6);
+  metric("bytes_per_second",
+         "gauge",
+         "Average frame and response bytes per second",
+         s.bytes_per_second());
+  metric("frames_per_second",
+         "gauge",
+         "Average frames per second",
+         s.frames_per_second());
+
+  // RTT histogram with cumulative buckets
+  header("rtt_seconds", "histogram", "Round-trip time of frames");
+  uint64_t count{};
+  for (auto i{0uz}; i < size(s.rtt); ++i) {
+    count += s.rtt[i];
+    std::array<char, 32uz> buf;
+    auto const le{i < size(rtt_buckets)
+                    ? chars(static_cast<double>(rtt_buckets[i]) / 1e6, buf)
+                    : "+Inf"sv};
+    sample("rtt_seconds_bucket", {"le=\""sv, le, "\""sv});
+    number(count);
+    std::invoke(f, "\n"sv);
+  }
+  sample("rtt_seconds_sum");
+  number(static_cast<double>(s.rtt_sum) / 1e6);
+  std::invoke(f, "\n"sv);
+  sample("rtt_seconds_count");
+  number(count);
+  std::invoke(f, "\n"sv);
+
+  // Responses of commands which occurred
+  header("responses_total", "counter", "Responses per command");
+  for (auto i{0uz}; i < metrics_commands; ++i)
+    for (auto const& [n, response] :
+         {std::pair{s.acks[i], "ack"sv}, std::pair{s.naks[i], "nak"sv}}) {
+      if (!n) continue;
+      std::array<char, 32uz> buf;
+      auto name{detail::command_name(i)};
+      if (empty(name)) name = chars(i, buf);
+      sample("responses_total",
+             {"command=\""sv, name, "\",response=\""sv, response, "\""sv});
+      number(n);
+      std::invoke(f, "\n"sv);
+    }
+
+  if (s.total)
+    metric("progress_ratio",
+           "gauge",
+           "Progress made",
+           static_cast<double>(std::min(s.progress, s.total)) /
+             static_cast<double>(s.total));
+  if (auto const eta{s.eta()})
+    metric("eta_seconds",
+           "gauge",
+           "Estimated time until the session is done",
+           static_cast<double>(*eta) / 1e6);
+}
+
+} // namespace ulf::susiv2
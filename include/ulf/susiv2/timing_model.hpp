@@ -0,0 +1,373 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// Link timing model and update time estimation
+///
+/// \file   ulf/susiv2/timing_model.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <zusi/command.hpp>
+#include "compression.hpp"
+#include "header.hpp"
+#include "multi.hpp"
+#include "pipeline.hpp"
+#include "utility.hpp"
+
+namespace ulf::susiv2 {
+
+/// Link parameters
+struct LinkTiming {
+  uint32_t baud{115'200u};  ///< Baud rate (10 bit per byte)
+  uint32_t latency{1'000u}; ///< Host reaction to a response, e.g. USB [µs]
+  uint32_t turnaround{};    ///< Receiver reaction before a response [µs]
+};
+
+/// Busy durations per command [µs]
+///
+/// Busy durations only apply to frames with the busy flag set. ZppErase
+/// erases the whole flash, so its duration depends on the decoder.
+struct BusyTiming {
+  uint32_t cvread{};
+  uint32_t cvwrite{5'000u};
+  uint32_t zpperase{};
+  uint32_t zppwrite{700u};
+  uint32_t other{};
+
+  /// Busy duration of command
+  constexpr uint32_t operator()(uint8_t cmd) const {
+    switch (static_cast<zusi::Command>(cmd)) {
+      case zusi::Command::CvRead: return cvread;
+      case zusi::Command::CvWrite: return cvwrite;
+      case zusi::Command::ZppErase: return zpperase;
+      case zusi::Command::ZppWrite: return zppwrite;
+      default: return other;
+    }
+  }
+};
+
+/// What the timing of a frame depends on
+struct FrameShape {
+  size_t frame_size{};    ///< Frame size [byte]
+  size_t response_size{}; ///< Response size if all packets are acked [byte]
+  uint32_t busy{};        ///< Receiver busy [µs]
+  bool sequenced{};       ///< Frame and response carry a sequence number
+};
+
+/// Get shape of a frame
+///
+/// The response to multi-packet frames is assumed to carry a CRC8 for every
+/// CvRead, Features and ZppLcDcQuery packet.
+///
+/// \param  frame         SUSIV2 frame
+/// \param  busy          Busy durations per command
+/// \retval FrameShape    Shape of frame
+/// \retval std::nullopt  Frame incomplete or corrupt
+constexpr std::optional<FrameShape>
+get_frame_shape(std::span<uint8_t const> frame, BusyTiming const& busy = {}) {
+  auto const flags{get_flags(frame)};
+  auto const answer_length{get_answer_length(frame)};
+  if (!flags || !answer_length) return std::nullopt;
+  FrameShape shape{.frame_size = size(frame),
+                   .sequenced = (*flags & sequence_flag) != 0u};
+  auto packets{
+    frame.subspan(std::min(shape.sequenced ? sequence_header_size : header_size,
+                           size(frame)))};
+
+  // Packets
+  size_t count{1uz};
+  if (*flags & multi_flag) {
+    if (empty(packets) || !packets.front()) return std::nullopt;
+    count = packets.front();
+    packets = packets.subspan(1uz);
+  }
+  size_t crcs{};
+  for (auto i{0uz}; i < count; ++i) {
+    std::optional<size_t> packet_size;
+    if (!(*flags & compressed_flag)) {
+      if (auto const s{get_packet_size(packets)}; s) packet_size = *s;
+    } else if (size(packets) > compressed_len_pos)
+      packet_size = compressed_zppwrite_size(packets[compressed_len_pos]);
+    if (!packet_size || *packet_size > size(packets)) return std::nullopt;
+    auto const cmd{packets[zusi::cmd_pos]};
+    if (*flags & busy_flag) shape.busy += busy(cmd);
+    crcs += cmd == std::to_underlying(zusi::Command::CvRead) ||
+            cmd == std::to_underlying(zusi::Command::Features) ||
+            cmd == std::to_underlying(zusi::Command::ZppLcDcQuery);
+    packets = packets.subspan(*packet_size);
+  }
+
+  // Response
+  if (*flags & multi_flag) shape.response_size = count + *answer_length + crcs;
+  else
+    shape.response_size =
+      1uz + (*answer_length ? *answer_length + 1uz : 0uz);
+  shape.response_size += shape.sequenced;
+  return shape;
+}
+
+/// Time spent on the critical path per phase [µs]
+struct CriticalPath {
+  uint64_t transmit{};   ///< Sending frames
+  uint64_t turnaround{}; ///< Receiver reacting
+  uint64_t busy{};       ///< Receiver busy
+  uint64_t response{};   ///< Sending responses
+  uint64_t latency{};    ///< Host reacting
+};
+
+/// Estimate of a frame stream
+struct TimingEstimate {
+  uint64_t total{};          ///< Total time [µs]
+  size_t frames{};           ///< Number of frames
+  uint64_t frame_bytes{};    ///< Bytes sent
+  uint64_t response_bytes{}; ///< Bytes received
+  CriticalPath critical_path{};
+};
+
+/// Link timing model
+///
+/// Frames are sent back to back as long as the window allows. The receiver
+/// executes them one after the other once they're complete and answers each
+/// as soon as it's done and the previous response has been sent. The host
+/// reacts to a response after the latency, which frees a slot of the window.
+/// With a window of 1 this is stop-and-wait, where every frame costs
+///   transmit + turnaround + busy + response + latency
+/// Larger windows hide everything but the slowest of transmit, busy and
+/// response. Frames which aren't sequenced are treated as if they were once
+/// the window is larger than 1.
+///
+/// Every point in time carries the phases which led up to it. The estimate
+/// therefore reports what the critical path consists of, e.g. whether a
+/// faster link or a larger window would help.
+class TimingModel {
+public:
+  /// Ctor
+  ///
+  /// \param  link    Link parameters
+  /// \param  busy    Busy durations per command
+  /// \param  window  Number of frames in flight (1 is stop-and-wait)
+  constexpr explicit TimingModel(LinkTiming link = {},
+                                 BusyTiming busy = {},
+                                 size_t window = 1uz)
+    : _link{link}, _busy{busy},
+      _window{std::clamp(window, 1uz, max_window_size)},
+      _byte{10e6 / std::max(link.baud, 1u)} {}
+
+  /// Add frame
+  ///
+  /// \param  frame SUSIV2 frame
+  /// \retval true  Frame added
+  /// \retval false Frame incomplete or corrupt
+  constexpr bool push(std::span<uint8_t const> frame) {
+    auto const shape{get_frame_shape(frame, _busy)};
+    if (shape) push(*shape);
+    return shape.has_value();
+  }
+
+  /// Add frame
+  ///
+  /// \param  shape Shape of frame
+  constexpr void push(FrameShape shape) {
+    auto const seq{_window > 1uz && !shape.sequenced};
+    auto const frame_size{shape.frame_size + seq};
+    auto const response_size{shape.response_size + seq};
+
+    // Send once the line is free and the window has a slot
+    auto& slot{_replies[_frames % _window]};
+    auto t{later(_line, _frames >= _window ? slot : Point{})};
+    t.add(&Path::transmit, static_cast<double>(frame_size) * _byte);
+    _line = t;
+
+    // Execute once complete and the receiver is done with the previous frame
+    t = later(t, _receiver);
+    t.add(&Path::turnaround, _link.turnaround);
+    t.add(&Path::busy, shape.busy);
+    _receiver = t;
+
+    // Answer once the previous response has been sent
+    t = later(t, _response);
+    t.add(&Path::response, static_cast<double>(response_size) * _byte);
+    _response = t;
+
+    // Host reacts
+    t.add(&Path::latency, _link.latency);
+    slot = _last = t;
+
+    ++_frames;
+    _frame_bytes += frame_size;
+    _response_bytes += response_size;
+  }
+
+  /// Estimate of all frames added so far
+  constexpr TimingEstimate estimate() const {
+    auto const us{
+      [](double t) { return static_cast<uint64_t>(std::llround(t)); }};
+    return {.total = us(_last.time),
+            .frames = _frames,
+            .frame_bytes = _frame_bytes,
+            .response_bytes = _response_bytes,
+            .critical_path = {.transmit = us(_last.path.transmit),
+                              .turnaround = us(_last.path.turnaround),
+                              .busy = us(_last.path.busy),
+                              .response = us(_last.path.response),
+                              .latency = us(_last.path.latency)}};
+  }
+
+  /// Window
+  constexpr size_t window() const { return _window; }
+
+private:
+  struct Path {
+    double transmit{};
+    double turnaround{};
+    double busy{};
+    double response{};
+    double latency{};
+  };
+
+  struct Point {
+    double time{};
+    Path path{};
+
+    constexpr void add(double Path::*phase, double dt) {
+      time += dt;
+      path.*phase += dt;
+    }
+  };
+
+  static constexpr Point later(Point const& a, Point const& b) {
+    return a.time < b.time ? b : a;
+  }
+
+  LinkTiming _link;
+  BusyTiming _busy;
+  size_t _window;
+  double _byte; ///< Time per byte [µs]
+  Point _line{};
+  Point _receiver{};
+  Point _response{};
+  Point _last{};
+  std::array<Point, max_window_size> _replies{};
+  size_t _frames{};
+  uint64_t _frame_bytes{};
+  uint64_t _response_bytes{};
+};
+
+/// Estimate frame stream
+///
+/// \tparam R       Range of frames
+/// \param  frames  Frames
+/// \param  link    Link parameters
+/// \param  busy    Busy durations per command
+/// \param  window  Number of frames in flight (1 is stop-and-wait)
+/// \return Estimate (frames which are incomplete or corrupt are skipped)
+template<std::ranges::input_range R>
+requires std::convertible_to<std::ranges::range_reference_t<R>,
+                             std::span<uint8_t const>>
+constexpr TimingEstimate estimate(R&& frames,
+                                  LinkTiming link = {},
+                                  BusyTiming busy = {},
+                                  size_t window = 1uz) {
+  TimingModel model{link, busy, window};
+  for (std::span<uint8_t const> frame : frames) model.push(frame);
+  return model.estimate();
+}
+
+/// Estimate ZPP update
+///
+/// Models a ZppErase followed by plain ZppWrites of chunk_size bytes each, so
+/// that different chunk sizes and windows can be compared without building
+/// any frames. Compressed or multi-packet streams depend on the data and have
+/// to be estimated from the actual frames.
+///
+/// \param  image_size  Image size [byte]
+/// \param  chunk_size  Data bytes per ZppWrite (1-256)
+/// \param  link        Link parameters
+/// \param  busy        Busy durations per command
+/// \param  window      Number of frames in flight (1 is stop-and-wait)
+/// \return Estimate
+constexpr TimingEstimate estimate_zpp(size_t image_size,
+                                      size_t chunk_size = 256uz,
+                                      LinkTiming link = {},
+                                      BusyTiming busy = {},
+                                      size_t window = 1uz) {
+  chunk_size = std::clamp(chunk_size, 1uz, 256uz);
+  TimingModel model{link, busy, window};
+  model.push({.frame_size = header_size + zpperase_size,
+              .response_size = 1uz,
+              .busy = busy.zpperase});
+  for (auto i{0uz}; i < image_size; i += chunk_size) {
+    auto const n{std::min(chunk_size, image_size - i)};
+    model.push(
+      {.frame_size = header_size + zppwrite_size(static_cast<uint8_t>(n - 1uz)),
+       .response_size = 1uz,
+       .busy = busy.zppwrite});
+  }
+  return model.estimate();
+}
+
+/// Estimated time left during an update
+///
+/// Runs the same model over the frames done so far and compares it to the
+/// elapsed time. The remaining time of the estimate is scaled accordingly, so
+/// a session running slower than predicted (e.g. longer busy phases) gets a
+/// longer ETA.
+class UpdateEta {
+public:
+  /// Ctor
+  ///
+  /// \param  total   Estimate of the whole update
+  /// \param  link    Link parameters the estimate is based on
+  /// \param  busy    Busy durations the estimate is based on
+  /// \param  window  Window the estimate is based on
+  constexpr UpdateEta(TimingEstimate const& total,
+                      LinkTiming link = {},
+                      BusyTiming busy = {},
+                      size_t window = 1uz)
+    : _total{total.total}, _model{link, busy, window} {}
+
+  /// Frame done
+  ///
+  /// \param  frame   SUSIV2 frame which has been answered
+  /// \param  elapsed Time since start of update [µs]
+  constexpr void done(std::span<uint8_t const> frame, uint64_t elapsed) {
+    _model.push(frame);
+    _elapsed = elapsed;
+  }
+
+  /// Estimated time left [µs]
+  constexpr uint64_t remaining() const {
+    auto const predicted{_model.estimate().total};
+    if (predicted >= _total) return 0u;
+    if (!predicted || !_elapsed) return _total - predicted;
+    return static_cast<uint64_t>(static_cast<double>(_total - predicted) *
+                                 static_cast<double>(_elapsed) /
+                                 static_cast<double>(predicted));
+  }
+
+  /// Progress (0-1)
+  constexpr double progress() const {
+    return _total ? std::min(static_cast<double>(_model.estimate().total) /
+                               static_cast<double>(_total),
+                             1.0)
+                  : 1.0;
+  }
+
+private:
+  uint64_t _total;
+  TimingModel _model;
+  uint64_t _elapsed{};
+};
+
+} // namespace ulf::susiv2
@@ -17,6 +17,7 @@
 #include <ztl/inplace_vector.hpp>
 #include <zusi/command.hpp>
 #include <zusi/utility.hpp>
+#include "parse_result.hpp"
 
 namespace ulf::susiv2 {
 
@@ -30,6 +31,110 @@ inline constexpr size_t zpplcdcquery_size{6uz};
 inline constexpr size_t features_size{2uz};
 inline constexpr size_t exit_size{5uz};
 
+/// Helper to write a 32 bit value in big-endian byte order
+///
+/// \param  word  Value to write
+/// \param  data  Pointer to at least 4 bytes
+/// \return Pointer past the last written byte
+constexpr uint8_t* uint32_2data(uint32_t word, uint8_t* data) {
+  *data++ = static_cast<uint8_t>(word >> 24u);
+  *data++ = static_cast<uint8_t>(word >> 16u);
+  *data++ = static_cast<uint8_t>(word >> 8u);
+  *data++ = static_cast<uint8_t>(word);
+  return data;
+}
+
+namespace flat {
+
+/// Helper to get a command byte from a ZUSI frame
+///
+/// \param  frame                   ZUSI frame to search
+/// \retval zusi::Command           Command was found
+/// \retval Status::Incomplete      Frame is too short to contain a command
+/// \retval Status::UnknownCommand  Unknown command
+constexpr ParseResult<zusi::Command>
+get_command(std::span<uint8_t const> frame) {
+  if (size(frame) <= zusi::cmd_pos) return Status::Incomplete;
+  if (!zusi::is_valid_command(frame[zusi::cmd_pos]))
+    return Status::UnknownCommand;
+  return static_cast<zusi::Command>(frame[zusi::cmd_pos]);
+}
+
+/// Helper to get the size of a ZUSI packet from its first bytes
+///
+/// \param  packet                  Start of ZUSI packet
+/// \retval uint16_t                Size of the complete packet
+/// \retval Status::Incomplete      Packet is too short to determine its size
+/// \retval Status::UnknownCommand  Unknown command
+constexpr ParseResult<uint16_t>
+get_packet_size(std::span<uint8_t const> packet) {
+  if (size(packet) <= zusi::cmd_pos) return Status::Incomplete;
+  switch (static_cast<zusi::Command>(packet[zusi::cmd_pos])) {
+    case zusi::Command::CvRead: return uint16_t{cvread_size};
+    case zusi::Command::CvWrite:
+      if (size(packet) <= zusi::data_cnt_pos) return Status::Incomplete;
+      return static_cast<uint16_t>(cvwrite_size(packet[zusi::data_cnt_pos]));
+    case zusi::Command::ZppWrite:
+      if (size(packet) <= zusi::data_cnt_pos) return Status::Incomplete;
+      return static_cast<uint16_t>(zppwrite_size(packet[zusi::data_cnt_pos]));
+    case zusi::Command::ZppErase: return uint16_t{zpperase_size};
+    case zusi::Command::Features: return uint16_t{features_size};
+    case zusi::Command::Exit: return uint16_t{exit_size};
+    case zusi::Command::ZppLcDcQuery: return uint16_t{zpplcdcquery_size};
+    default: return Status::UnknownCommand;
+  }
+}
+
+/// Helper to get a CV or Data count from a ZUSI frame
+///
+/// \param  frame                   ZUSI frame to search
+/// \retval uint8_t                 Count that was found
+/// \retval Status::Incomplete      Frame is too short to contain a count
+/// \retval Status::UnknownCommand  Frame cannot contain a count
+constexpr ParseResult<uint8_t> get_count(std::span<uint8_t const> frame) {
+  if (size(frame) <= zusi::data_cnt_pos) return Status::Incomplete;
+  switch (static_cast<zusi::Command>(frame[zusi::cmd_pos])) {
+    case zusi::Command::CvRead: [[fallthrough]];
+    case zusi::Command::CvWrite: [[fallthrough]];
+    case zusi::Command::ZppWrite: return frame[zusi::data_cnt_pos];
+    default: return Status::UnknownCommand;
+  }
+}
+
+/// Helper to get an address from a ZUSI frame
+///
+/// \param  frame                   ZUSI frame to search
+/// \retval uint32_t                Address from the ZUSI frame
+/// \retval Status::Incomplete      Frame is too short to contain an address
+/// \retval Status::UnknownCommand  Frame cannot contain an address
+constexpr ParseResult<uint32_t> get_address(std::span<uint8_t const> frame) {
+  if (size(frame) <= zusi::addr_pos + 3uz) return Status::Incomplete;
+  switch (static_cast<zusi::Command>(frame[zusi::cmd_pos])) {
+    case zusi::Command::CvRead: [[fallthrough]];
+    case zusi::Command::CvWrite: [[fallthrough]];
+    case zusi::Command::ZppWrite:
+      return zusi::data2uint32(&frame[zusi::addr_pos]);
+    default: return Status::UnknownCommand;
+  }
+}
+
+/// Helper to get the checksum of a ZUSI frame
+///
+/// \param  frame                   ZUSI frame to search
+/// \retval uint8_t                 Checksum of the ZUSI frame
+/// \retval Status::Incomplete      Frame is too short to contain a checksum
+/// \retval Status::Corrupt         Frame is longer than its packet
+/// \retval Status::UnknownCommand  Unknown command
+constexpr ParseResult<uint8_t> get_checksum(std::span<uint8_t const> frame) {
+  auto const packet_size{get_packet_size(frame)};
+  if (!packet_size) return packet_size.status();
+  if (size(frame) < *packet_size) return Status::Incomplete;
+  if (size(frame) > *packet_size) return Status::Corrupt;
+  return frame[*packet_size - 1uz];
+}
+
+} // namespace flat
+
 /// Helper to get a command byte from a ZUSI frame
 ///
 /// \param  frame         ZUSI frame to search
@@ -38,12 +143,18 @@ inline constexpr size_t exit_size{5uz};
 /// \retval std::errc     Unknown command
 constexpr std::expected<std::optional<zusi::Command>, std::errc>
 get_command(std::span<uint8_t const> frame) {
-  if (size(frame) > zusi::cmd_pos) {
-    if (zusi::is_valid_command(frame[zusi::cmd_pos]))
-      return static_cast<zusi::Command>(frame[zusi::cmd_pos]);
-    else return std::unexpected{std::errc::protocol_error};
-  }
-  return std::nullopt;
+  return to_expected<zusi::Command>(flat::get_command(frame));
+}
+
+/// Helper to get the size of a ZUSI packet from its first bytes
+///
+/// \param  packet        Start of ZUSI packet
+/// \retval size_t        Size of the complete packet including checksum
+/// \retval std::nullopt  Packet is too short to determine its size
+/// \retval std::errc     Unknown command
+constexpr std::expected<std::optional<size_t>, std::errc>
+get_packet_size(std::span<uint8_t const> packet) {
+  return to_expected<size_t>(flat::get_packet_size(packet));
 }
 
 /// Helper to get a CV or Data count from a ZUSI frame
@@ -54,14 +165,7 @@ get_command(std::span<uint8_t const> frame) {
 /// \retval std::errc     Frame cannot contain a count (e.g. FlashDelete)
 constexpr std::expected<std::optional<uint8_t>, std::errc>
 get_count(std::span<uint8_t const> frame) {
-  if (size(frame) > zusi::data_cnt_pos)
-    switch (static_cast<zusi::Command>(frame[zusi::cmd_pos])) {
-      case zusi::Command::CvRead: [[fallthrough]];
-      case zusi::Command::CvWrite: [[fallthrough]];
-      case zusi::Command::ZppWrite: return frame[zusi::data_cnt_pos];
-      default: return std::unexpected{std::errc::protocol_error};
-    }
-  return std::nullopt;
+  return to_expected<uint8_t>(flat::get_count(frame));
 }
 
 /// Helper to get an address from a ZUSI frame
@@ -73,15 +177,7 @@ get_count(std::span<uint8_t const> frame) {
 ///                       valid bounds
 constexpr std::expected<std::optional<uint32_t>, std::errc>
 get_address(std::span<uint8_t const> frame) {
-  if (size(frame) > (zusi::addr_pos + 3uz))
-    switch (static_cast<zusi::Command>(frame[zusi::cmd_pos])) {
-      case zusi::Command::CvRead: [[fallthrough]];
-      case zusi::Command::CvWrite: [[fallthrough]];
-      case zusi::Command::ZppWrite:
-        return zusi::data2uint32(&frame[zusi::addr_pos]);
-      default: return std::unexpected{std::errc::protocol_error};
-    }
-  return std::nullopt;
+  return to_expected<uint32_t>(flat::get_address(frame));
 }
 
 /// Helper to get flash / CV data from a ZUSI frame
@@ -135,45 +231,14 @@ get_exit_flags(std::span<uint8_t const> frame) {
 ///
 /// \param  frame         ZUSI frame to search
 /// \retval uint8_t       Checksum of the ZUSI frame
-/// \retval std::nullopt  Frame is too short to contain a checksum
+/// \retval std::nullopt  Frame is too short or longer than its packet
 /// \retval std::errc     Frame data is corrupt
 constexpr std::expected<std::optional<uint8_t>, std::errc>
 get_checksum(std::span<uint8_t const> frame) {
-  // TODO: Replace magic numbers with macros/constexpr/similar
-
-  if (size(frame) > zusi::cmd_pos) {
-    switch (static_cast<zusi::Command>(frame[zusi::cmd_pos])) {
-      case zusi::Command::CvRead:
-        if (size(frame) == zusi::addr_pos + 3uz + 1uz + 1uz)
-          return frame[zusi::addr_pos + 3uz + 1uz];
-        break;
-      case zusi::Command::CvWrite: [[fallthrough]];
-      case zusi::Command::ZppWrite:
-        if (size(frame) > zusi::data_cnt_pos)
-          if (size(frame) ==
-              zusi::data_pos + frame[zusi::data_cnt_pos] + 1uz + 1uz)
-            return frame[zusi::data_pos + frame[zusi::data_cnt_pos] + 1uz];
-        break;
-      case zusi::Command::ZppErase:
-        if (size(frame) == zusi::sec_bytes_pos + 1uz + 1uz + 1uz)
-          return frame[zusi::sec_bytes_pos + 1uz + 1uz];
-        break;
-      case zusi::Command::Features:
-        if (size(frame) == zusi::cmd_pos + 1uz + 1uz)
-          return frame[zusi::cmd_pos + 1uz];
-        break;
-      case zusi::Command::Exit:
-        if (size(frame) == zusi::exit_flags_pos + 1uz + 1uz)
-          return frame[zusi::exit_flags_pos + 1uz];
-        break;
-      case zusi::Command::ZppLcDcQuery:
-        if (size(frame) == zpplcdcquery_size)
-          return frame[zpplcdcquery_size - 1uz];
-        break;
-      default: return std::unexpected{std::errc::protocol_error};
-    }
-  }
-  return std::nullopt;
+  auto const crc{flat::get_checksum(frame)};
+  // Unlike the flat API trailing bytes aren't an error here
+  if (crc.status() == Status::Corrupt) return std::nullopt;
+  return to_expected<uint8_t>(crc);
 }
 
 } // namespace ulf::susiv2
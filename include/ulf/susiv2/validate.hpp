@@ -10,34 +10,79 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <system_error>
+#include <zusi/crc8.hpp>
+#include "crc8.hpp"
 #include "utility.hpp"
 
 namespace ulf::susiv2 {
 
+namespace flat {
+
+/// Validate ZUSI frame
+///
+/// \param  frame                   Frame to validate
+/// \retval Status::Ok              Frame is valid and ready to use
+/// \retval Status::Incomplete      Frame is incomplete
+/// \retval Status::Corrupt         Checksum mismatch or frame is longer than
+///                                 its packet
+/// \retval Status::UnknownCommand  Unknown command
+constexpr Status validate(std::span<uint8_t const> frame) {
+  auto const crc{get_checksum(frame)};
+  if (!crc) return crc.status();
+  return zusi::crc8(frame.first(size(frame) - 1uz)) == *crc ? Status::Ok
+                                                            : Status::Corrupt;
+}
+
+} // namespace flat
+
 /// Validate ZUSI frame
 ///
 /// \param  frame         Frame to validate
 /// \retval true          Frame is valid and ready to use
-/// \retval std::nullopt  Frame is incomplete
+/// \retval std::nullopt  Frame is incomplete or longer than its packet
 /// \retval std::errc     Frame data is corrupt and unusable
 inline std::expected<std::optional<bool>, std::errc> const
 validate(std::span<uint8_t const> const& frame) {
-  auto const cmd{get_command(frame)};
-  auto const crc{get_checksum(frame)};
+  auto const status{flat::validate(frame)};
+  if (status == Status::Ok) return true;
+  // Unlike the flat API trailing bytes aren't an error here
+  if (status == Status::Incomplete ||
+      flat::get_checksum(frame).status() == Status::Corrupt)
+    return std::nullopt;
+  return std::unexpected{to_errc(status)};
+}
 
-  if (cmd && crc) {
-    if (*cmd && *crc) {
-      if (zusi::crc8({cbegin(frame), cend(frame) - 1}) == **crc) return true;
-      else return std::unexpected{std::errc::protocol_error};
+/// Validate many ZUSI frames at once
+///
+/// Equivalent to calling validate on each frame but with the CRC8 of
+/// multiple frames calculated interleaved (see crc8_batch). Frames are either
+/// valid or not, incomplete frames are considered invalid.
+///
+/// \param  frames  Frames to validate
+/// \param  valid   Bitmap with one bit per frame (LSB first), set if valid,
+///                 must hold at least (size(frames) + 31) / 32 words
+/// \return Number of valid frames
+constexpr size_t
+validate_batch(std::span<std::span<uint8_t const> const> frames,
+               std::span<uint32_t> valid) {
+  std::ranges::fill(valid.first((size(frames) + 31uz) / 32uz), 0u);
+  size_t count{};
+  std::array<uint8_t, 64uz> crcs;
+  for (auto i{0uz}; i < size(frames); i += size(crcs)) {
+    auto const block{frames.subspan(i, std::min(size(crcs), size(frames) - i))};
+    crc8_batch(block, crcs);
+    for (auto j{0uz}; j < size(block); ++j) {
+      // CRC8 over a frame including its checksum is 0
+      auto const packet_size{get_packet_size(block[j])};
+      if (crcs[j] || !packet_size || *packet_size != size(block[j])) continue;
+      valid[(i + j) / 32uz] |= 1u << ((i + j) % 32uz);
+      ++count;
     }
-    // Incomplete
-    else
-      return std::nullopt;
   }
-  // ValidationError
-  else
-    return std::unexpected{cmd ? cmd.error() : crc.error()};
+  return count;
 }
 
 } // namespace ulf::susiv2
@@ -0,0 +1,176 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+/// ULF_SUSIV2 C API
+///
+/// \file   susiv2.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "ulf/susiv2.h"
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <utility>
+#include "ulf/susiv2.hpp"
+
+namespace {
+
+static_assert(ULF_SUSIV2_STATUS_OK ==
+              std::to_underlying(ulf::susiv2::Status::Ok));
+static_assert(ULF_SUSIV2_STATUS_INCOMPLETE ==
+              std::to_underlying(ulf::susiv2::Status::Incomplete));
+static_assert(ULF_SUSIV2_STATUS_CORRUPT ==
+              std::to_underlying(ulf::susiv2::Status::Corrupt));
+static_assert(ULF_SUSIV2_STATUS_UNKNOWN_COMMAND ==
+              std::to_underlying(ulf::susiv2::Status::UnknownCommand));
+static_assert(ULF_SUSIV2_STATUS_BAD_HEADER ==
+              std::to_underlying(ulf::susiv2::Status::BadHeader));
+
+/// Largest size of a buffer addressable by a slice
+constexpr size_t max_buf_size{UINT32_MAX};
+
+/// Get view on slice or std::nullopt if it's out of bounds
+std::optional<std::span<uint8_t const>>
+view(uint8_t const* buf, size_t buf_size, ulf_susiv2_slice slice) {
+  buf_size = std::min(buf_size, max_buf_size);
+  if (slice.offset > buf_size || slice.size > buf_size - slice.offset)
+    return std::nullopt;
+  return std::span{buf + slice.offset, slice.size};
+}
+
+/// Convert flat status to status of the C API
+int32_t to_status(ulf::susiv2::Status status) {
+  return std::to_underlying(status);
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t ulf_susiv2_abi_version(void) { return ULF_SUSIV2_ABI_VERSION; }
+
+size_t ulf_susiv2_decode(uint8_t const* buf,
+                         size_t buf_size,
+                         ulf_susiv2_slice const* frames,
+                         size_t count,
+                         ulf_susiv2_slice* packets,
+                         int32_t* status) {
+  size_t ok{};
+  for (auto i{0uz}; i < count; ++i) {
+    packets[i] = {.offset = frames[i].offset, .size = 0u};
+    auto const frame{view(buf, buf_size, frames[i])};
+    if (!frame) {
+      status[i] = ULF_SUSIV2_STATUS_OUT_OF_BOUNDS;
+      continue;
+    }
+    auto const packet{ulf::susiv2::flat::frame2packet(*frame)};
+    status[i] = to_status(packet.status());
+    if (!packet) continue;
+    packets[i] = {.offset = static_cast<uint32_t>(data(*packet) - buf),
+                  .size = static_cast<uint32_t>(size(*packet))};
+    ++ok;
+  }
+  return ok;
+}
+
+size_t ulf_susiv2_validate(uint8_t const* buf,
+                           size_t buf_size,
+                           ulf_susiv2_slice const* frames,
+                           size_t count,
+                           uint32_t* valid,
+                           int32_t* status) {
+  // Locate packets block by block, frames without packet stay empty
+  constexpr auto block_size{64uz};
+  std::array<std::span<uint8_t const>, block_size> block;
+  std::array<int32_t, block_size> block_status;
+  std::array<uint32_t, block_size / 32uz> bits;
+  std::fill_n(valid, (count + 31uz) / 32uz, 0u);
+  size_t ok{};
+  for (auto i{0uz}; i < count; i += block_size) {
+    auto const n{std::min(block_size, count - i)};
+    for (auto j{0uz}; j < n; ++j) {
+      block[j] = {};
+      auto const frame{view(buf, buf_size, frames[i + j])};
+      if (!frame) {
+        block_status[j] = ULF_SUSIV2_STATUS_OUT_OF_BOUNDS;
+        continue;
+      }
+      auto const packet{ulf::susiv2::flat::locate_packet(*frame)};
+      if (packet) {
+        block[j] = *packet;
+        block_status[j] = ULF_SUSIV2_STATUS_CORRUPT;
+      } else block_status[j] = to_status(packet.status());
+    }
+    ok += ulf::susiv2::validate_batch(std::span{block}.first(n), bits);
+    for (auto j{0uz}; j < n; ++j) {
+      if (bits[j / 32uz] & (1u << (j % 32uz))) {
+        valid[(i + j) / 32uz] |= 1u << ((i + j) % 32uz);
+        block_status[j] = ULF_SUSIV2_STATUS_OK;
+      }
+      if (status) status[i + j] = block_status[j];
+    }
+  }
+  return ok;
+}
+
+size_t ulf_susiv2_encode(uint8_t const* buf,
+                         size_t buf_size,
+                         ulf_susiv2_slice const* packets,
+                         uint32_t const* answer_lengths,
+                         uint8_t const* flags,
+                         size_t count,
+                         uint8_t* out,
+                         size_t out_size,
+                         ulf_susiv2_slice* frames) {
+  out_size = std::min(out_size, max_buf_size);
+  size_t o{};
+  for (auto i{0uz}; i < count; ++i) {
+    auto const packet{view(buf, buf_size, packets[i])};
+    if (!packet || out_size - o < ulf::susiv2::header_size + size(*packet))
+      return i;
+    auto const first{o};
+    ulf::susiv2::uint32_2data(answer_lengths[i],
+                              &out[o + ulf::susiv2::answer_length_pos]);
+    out[o + ulf::susiv2::flags_pos] = flags[i];
+    o += ulf::susiv2::header_size;
+    std::ranges::copy(*packet, out + o);
+    o += size(*packet);
+    frames[i] = {.offset = static_cast<uint32_t>(first),
+                 .size = static_cast<uint32_t>(o - first)};
+  }
+  return count;
+}
+
+size_t ulf_susiv2_responses(uint8_t const* buf,
+                            size_t buf_size,
+                            ulf_susiv2_slice const* data,
+                            int32_t const* status,
+                            size_t count,
+                            uint8_t* out,
+                            size_t out_size,
+                            ulf_susiv2_slice* responses) {
+  out_size = std::min(out_size, max_buf_size);
+  size_t o{};
+  for (auto i{0uz}; i < count; ++i) {
+    zusi::Feedback fb{std::unexpected{std::errc::protocol_error}};
+    if (status[i] == ULF_SUSIV2_STATUS_OK) {
+      auto const bytes{view(buf, buf_size, data[i])};
+      zusi::Feedback::value_type fb_data;
+      if (!bytes || size(*bytes) > fb_data.capacity()) return i;
+      std::ranges::copy(*bytes, std::back_inserter(fb_data));
+      fb = fb_data;
+    }
+    auto const resp{ulf::susiv2::feedback2response(fb)};
+    if (out_size - o < size(resp)) return i;
+    responses[i] = {.offset = static_cast<uint32_t>(o),
+                    .size = static_cast<uint32_t>(size(resp))};
+    for (auto const byte : resp) out[o++] = byte;
+  }
+  return count;
+}
+
+} // extern "C"
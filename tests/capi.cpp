@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "ulf/susiv2.h"
+#include "ulf/susiv2.hpp"
+
+namespace {
+
+// Concatenate entries into one buffer and return their slices
+std::vector<ulf_susiv2_slice> pack(std::vector<std::vector<uint8_t>> const& in,
+                                   std::vector<uint8_t>& buf) {
+  std::vector<ulf_susiv2_slice> slices;
+  for (auto const& entry : in) {
+    slices.push_back({.offset = static_cast<uint32_t>(size(buf)),
+                      .size = static_cast<uint32_t>(size(entry))});
+    buf.insert(end(buf), begin(entry), end(entry));
+  }
+  return slices;
+}
+
+std::vector<uint8_t> const cvread_frame{
+  0x00u, 0x00u, 0x00u, 0x02u, 0x01u, 0x01u, 0x00u, 0x00u, 0x00u, 0x00u, 0xFFu,
+  0x02u};
+
+} // namespace
+
+TEST(capi, abi_version) {
+  EXPECT_EQ(ulf_susiv2_abi_version(), ULF_SUSIV2_ABI_VERSION);
+}
+
+TEST(capi, decode) {
+  auto corrupt{cvread_frame};
+  corrupt.back() ^= 0xFFu;
+  std::vector<uint8_t> buf;
+  auto frames{pack({cvread_frame,
+                    corrupt,
+                    {begin(cvread_frame), end(cvread_frame) - 1},
+                    cvread_frame},
+                   buf)};
+  frames.push_back({.offset = 1000u, .size = 12u});
+
+  std::vector<ulf_susiv2_slice> packets(size(frames));
+  std::vector<int32_t> status(size(frames));
+  EXPECT_EQ(ulf_susiv2_decode(data(buf),
+                              size(buf),
+                              data(frames),
+                              size(frames),
+                              data(packets),
+                              data(status)),
+            2uz);
+  EXPECT_EQ(status[0uz], ULF_SUSIV2_STATUS_OK);
+  EXPECT_EQ(status[1uz], ULF_SUSIV2_STATUS_CORRUPT);
+  EXPECT_EQ(status[2uz], ULF_SUSIV2_STATUS_INCOMPLETE);
+  EXPECT_EQ(status[3uz], ULF_SUSIV2_STATUS_OK);
+  EXPECT_EQ(status[4uz], ULF_SUSIV2_STATUS_OUT_OF_BOUNDS);
+
+  // Packets point into buf
+  EXPECT_EQ(packets[3uz].offset, frames[3uz].offset + 5u);
+  EXPECT_EQ(packets[3uz].size, 7u);
+}
+
+TEST(capi, validate) {
+  auto corrupt{cvread_frame};
+  corrupt.back() ^= 0xFFu;
+  std::vector<std::vector<uint8_t>> in;
+  for (auto i{0uz}; i < 100uz; ++i)
+    in.push_back(i % 7uz ? cvread_frame : corrupt);
+  std::vector<uint8_t> buf;
+  auto const frames{pack(in, buf)};
+
+  std::vector<uint32_t> valid(4uz, 0xFFFF'FFFFu);
+  std::vector<int32_t> status(size(frames));
+  EXPECT_EQ(ulf_susiv2_validate(data(buf),
+                                size(buf),
+                                data(frames),
+                                size(frames),
+                                data(valid),
+                                data(status)),
+            100uz - 15uz);
+  for (auto i{0uz}; i < 100uz; ++i) {
+    EXPECT_EQ(static_cast<bool>(valid[i / 32uz] & (1u << (i % 32uz))),
+              static_cast<bool>(i % 7uz));
+    EXPECT_EQ(status[i],
+              i % 7uz ? ULF_SUSIV2_STATUS_OK : ULF_SUSIV2_STATUS_CORRUPT);
+  }
+  EXPECT_EQ(valid[3uz] >> 4u, 0u);
+}
+
+TEST(capi, validate_agrees_with_decode) {
+  auto trailing{cvread_frame};
+  trailing.push_back(0xAAu);
+  auto flagged{cvread_frame};
+  std::vector<std::vector<uint8_t>> in{
+    cvread_frame, trailing, {begin(cvread_frame), end(cvread_frame) - 1}};
+  for (auto const flag : {ulf::susiv2::compressed_flag,
+                          ulf::susiv2::multi_flag,
+                          ulf::susiv2::sequence_flag}) {
+    flagged[ulf::susiv2::flags_pos] = flag;
+    in.push_back(flagged);
+  }
+  std::vector<uint8_t> buf;
+  auto frames{pack(in, buf)};
+  frames.push_back({.offset = 1000u, .size = 12u});
+
+  std::vector<uint32_t> valid(1uz);
+  std::vector<int32_t> status(size(frames));
+  std::vector<ulf_susiv2_slice> packets(size(frames));
+  std::vector<int32_t> decode_status(size(frames));
+  EXPECT_EQ(ulf_susiv2_validate(data(buf),
+                                size(buf),
+                                data(frames),
+                                size(frames),
+                                data(valid),
+                                data(status)),
+            2uz);
+  EXPECT_EQ(ulf_susiv2_decode(data(buf),
+                              size(buf),
+                              data(frames),
+                              size(frames),
+                              data(packets),
+                              data(decode_status)),
+            2uz);
+  EXPECT_EQ(status, decode_status);
+  EXPECT_EQ(valid[0uz], 0b11u);
+  EXPECT_EQ(status[3uz], ULF_SUSIV2_STATUS_BAD_HEADER);
+
+  // Status is optional
+  EXPECT_EQ(ulf_susiv2_validate(
+              data(buf), size(buf), data(frames), size(frames), data(valid), nullptr),
+            2uz);
+}
+
+TEST(capi, slices_beyond_4gib) {
+  // Offset and size fit into 32 bit each, but their sum doesn't
+  std::vector<uint8_t> buf(16uz);
+  ulf_susiv2_slice const frame{.offset = UINT32_MAX - 4u, .size = 12u};
+  ulf_susiv2_slice packet{};
+  int32_t status{};
+  EXPECT_EQ(
+    ulf_susiv2_decode(data(buf), SIZE_MAX, &frame, 1uz, &packet, &status),
+    0uz);
+  EXPECT_EQ(status, ULF_SUSIV2_STATUS_OUT_OF_BOUNDS);
+  uint32_t valid{};
+  EXPECT_EQ(
+    ulf_susiv2_validate(data(buf), SIZE_MAX, &frame, 1uz, &valid, &status),
+    0uz);
+  EXPECT_EQ(status, ULF_SUSIV2_STATUS_OUT_OF_BOUNDS);
+}
+
+TEST(capi, encode) {
+  std::vector<uint8_t> buf;
+  auto const packets{pack({{begin(cvread_frame) + 5, end(cvread_frame)},
+                           {begin(cvread_frame) + 5, end(cvread_frame)}},
+                          buf)};
+  std::vector<uint32_t> const answer_lengths{2u, 2u};
+  std::vector<uint8_t> const flags{ulf::susiv2::busy_flag,
+                                   ulf::susiv2::busy_flag};
+  std::vector<uint8_t> out(20uz);
+  std::vector<ulf_susiv2_slice> frames(2uz);
+
+  // Second frame doesn't fit
+  EXPECT_EQ(ulf_susiv2_encode(data(buf),
+                              size(buf),
+                              data(packets),
+                              data(answer_lengths),
+                              data(flags),
+                              size(packets),
+                              data(out),
+                              size(out),
+                              data(frames)),
+            1uz);
+  EXPECT_EQ(frames[0uz].size, size(cvread_frame));
+  EXPECT_TRUE(std::ranges::equal(std::span{out}.first(size(cvread_frame)),
+                                 cvread_frame));
+}
+
+TEST(capi, responses) {
+  std::vector<uint8_t> buf;
+  auto const fb_data{pack({{}, {42u}, {}}, buf)};
+  std::vector<int32_t> const status{
+    ULF_SUSIV2_STATUS_OK, ULF_SUSIV2_STATUS_OK, ULF_SUSIV2_STATUS_CORRUPT};
+  std::vector<uint8_t> out(16uz);
+  std::vector<ulf_susiv2_slice> responses(3uz);
+  EXPECT_EQ(ulf_susiv2_responses(data(buf),
+                                 size(buf),
+                                 data(fb_data),
+                                 data(status),
+                                 size(status),
+                                 data(out),
+                                 size(out),
+                                 data(responses)),
+            3uz);
+  EXPECT_EQ(responses[2uz].offset + responses[2uz].size, 5u);
+  EXPECT_EQ(out[0uz], ulf::susiv2::ack);
+  EXPECT_EQ(out[1uz], ulf::susiv2::ack);
+  EXPECT_EQ(out[2uz], 42u);
+  EXPECT_EQ(out[3uz], zusi::crc8(42u));
+  EXPECT_EQ(out[4uz], ulf::susiv2::nak);
+}
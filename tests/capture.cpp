@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+constexpr std::array<uint8_t, 12uz> cvread_frame{
+  0x00u, 0x00u, 0x00u, 0x02u, 0x01u, 0x01u, 0x00u, 0x00u, 0x00u, 0x00u, 0xFFu,
+  0x02u};
+constexpr std::array<uint8_t, 3uz> cvread_response{ack, 0x2Au, 0x5Du};
+
+std::vector<uint8_t> make_capture(CaptureWriter<256uz>& writer) {
+  std::vector<uint8_t> capture(capture_header_size);
+  write_capture_header(capture);
+  writer.drain([&](std::span<uint8_t const> chunk) {
+    std::ranges::copy(chunk, std::back_inserter(capture));
+  });
+  return capture;
+}
+
+} // namespace
+
+TEST(capture, write_and_read) {
+  CaptureWriter<256uz> writer;
+  ASSERT_TRUE(writer.push(Direction::Frame, 1000u, cvread_frame));
+  ASSERT_TRUE(writer.push(Direction::Response, 1500u, cvread_response));
+  auto const capture{make_capture(writer)};
+  ASSERT_EQ(size(capture),
+            capture_header_size + capture_record_size(size(cvread_frame)) +
+              capture_record_size(size(cvread_response)));
+
+  auto const view{read_capture(capture)};
+  ASSERT_TRUE(view);
+  auto it{view->begin()};
+  ASSERT_NE(it, view->end());
+  EXPECT_EQ(it->timestamp, 1000u);
+  EXPECT_EQ(it->direction, Direction::Frame);
+  EXPECT_TRUE(std::ranges::equal(it->data, cvread_frame));
+  // Records point into the capture itself
+  EXPECT_EQ(data(it->data), data(capture) + capture_header_size +
+                              capture_record_header_size);
+  ++it;
+  ASSERT_NE(it, view->end());
+  EXPECT_EQ(it->timestamp, 1500u);
+  EXPECT_EQ(it->direction, Direction::Response);
+  EXPECT_TRUE(std::ranges::equal(it->data, cvread_response));
+  ++it;
+  EXPECT_EQ(it, view->end());
+}
+
+TEST(capture, writer_wraps_around) {
+  CaptureWriter<256uz> writer;
+  std::vector<uint8_t> capture(capture_header_size);
+  write_capture_header(capture);
+  for (auto i{0uz}; i < 100uz; ++i) {
+    ASSERT_TRUE(writer.push(Direction::Frame, i, cvread_frame));
+    writer.drain([&](std::span<uint8_t const> chunk) {
+      std::ranges::copy(chunk, std::back_inserter(capture));
+    });
+  }
+  EXPECT_EQ(std::ranges::distance(*read_capture(capture)), 100);
+  EXPECT_EQ(replay(*read_capture(capture)).packets, 100uz);
+}
+
+TEST(capture, writer_drops_when_full) {
+  CaptureWriter<32uz> writer;
+  EXPECT_TRUE(writer.push(Direction::Frame, 0u, cvread_frame));
+  EXPECT_FALSE(writer.push(Direction::Frame, 1u, cvread_frame));
+  EXPECT_EQ(writer.dropped(), 1uz);
+}
+
+TEST(capture, invalid_header) {
+  std::vector<uint8_t> capture(capture_header_size);
+  EXPECT_FALSE(read_capture(capture));
+  write_capture_header(capture);
+  capture[4uz] = capture_version + 1u;
+  EXPECT_FALSE(read_capture(capture));
+}
+
+TEST(capture, truncated_record) {
+  CaptureWriter<256uz> writer;
+  writer.push(Direction::Frame, 0u, cvread_frame);
+  writer.push(Direction::Frame, 1u, cvread_frame);
+  auto capture{make_capture(writer)};
+  capture.pop_back();
+  EXPECT_EQ(std::ranges::distance(*read_capture(capture)), 1);
+}
+
+TEST(capture, replay) {
+  CaptureWriter<256uz> writer;
+  writer.push(Direction::Frame, 100u, cvread_frame);
+  writer.push(Direction::Response, 300u, cvread_response);
+  writer.push(
+    Direction::Frame, 400u, std::span{cbegin(cvread_frame), size_t{8uz}});
+  auto corrupt{cvread_frame};
+  corrupt.back() = 0xFFu;
+  writer.push(Direction::Frame, 500u, corrupt);
+  writer.push(Direction::Response, 1500u, std::array<uint8_t, 1uz>{nak});
+  auto const capture{make_capture(writer)};
+
+  size_t calls{};
+  auto const stats{replay(*read_capture(capture),
+                          [&](CaptureRecord const&, auto const&) { ++calls; })};
+  EXPECT_EQ(calls, 3uz);
+  EXPECT_EQ(stats.frames, 3uz);
+  EXPECT_EQ(stats.responses, 2uz);
+  EXPECT_EQ(stats.packets, 1uz);
+  EXPECT_EQ(stats.incomplete, 1uz);
+  EXPECT_EQ(stats.corrupt, 1uz);
+  EXPECT_EQ(stats.first, 100u);
+  EXPECT_EQ(stats.last, 1500u);
+  EXPECT_EQ(stats.rtt_min, 200u);
+  EXPECT_EQ(stats.rtt_max, 1000u);
+  EXPECT_EQ(stats.rtt_count, 2uz);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+TEST(compression, roundtrip) {
+  std::vector<uint8_t> data(256uz, 0xFFu);
+  std::iota(begin(data) + 10, begin(data) + 20, uint8_t{});
+  data[200uz] = 0x00u;
+  data[201uz] = 0x00u;
+
+  std::array<uint8_t, 256uz> compressed{};
+  auto const n{compress(data, compressed)};
+  ASSERT_TRUE(n);
+  EXPECT_LT(*n, size(data));
+
+  std::array<uint8_t, 256uz> decompressed{};
+  auto const m{decompress(std::span{compressed}.first(*n), decompressed)};
+  ASSERT_TRUE(m);
+  EXPECT_EQ(*m, size(data));
+  EXPECT_TRUE(std::ranges::equal(decompressed, data));
+}
+
+TEST(compression, incompressible) {
+  std::vector<uint8_t> data(256uz);
+  std::iota(begin(data), end(data), uint8_t{});
+  std::array<uint8_t, 255uz> compressed{};
+  EXPECT_FALSE(compress(data, compressed));
+}
+
+TEST(compression, decompress_is_bounded) {
+  // Run of 128 bytes into 16 byte buffer
+  std::array<uint8_t, 2uz> const run{0x81u, 0xAAu};
+  std::array<uint8_t, 16uz> out{};
+  EXPECT_FALSE(decompress(run, out));
+
+  // Literal run longer than input
+  std::array<uint8_t, 2uz> const literal{0x05u, 0xAAu};
+  EXPECT_FALSE(decompress(literal, out));
+}
+
+TEST(compression, compressed_frame) {
+  std::vector<uint8_t> data(256uz, 0x00u);
+  std::array<uint8_t, header_size + max_zppwrite_size> buf{};
+  auto const frame{zppwrite2frame(0x1234'5678u, data, buf)};
+  EXPECT_TRUE(*get_flags(frame) & compressed_flag);
+  EXPECT_TRUE(*get_flags(frame) & busy_flag);
+  EXPECT_LT(size(frame), header_size + zppwrite_size(0xFFu));
+
+  // Plain frame2packet doesn't know about compression
+  EXPECT_EQ(frame2packet(frame).error(), std::errc::not_supported);
+
+  std::array<uint8_t, max_zppwrite_size> packet_buf{};
+  auto const packet{frame2packet(frame, packet_buf)};
+  ASSERT_TRUE(packet);
+  ASSERT_TRUE(*packet);
+  EXPECT_EQ(size(**packet), zppwrite_size(0xFFu));
+  EXPECT_EQ(**get_address(**packet), 0x1234'5678u);
+  EXPECT_TRUE(
+    std::ranges::equal((**packet).subspan(zusi::data_pos, size(data)), data));
+  EXPECT_TRUE(*validate(**packet));
+
+  // Incomplete
+  EXPECT_FALSE(*frame2packet(frame.first(size(frame) - 1uz), packet_buf));
+}
+
+TEST(compression, raw_frame_if_smaller) {
+  std::vector<uint8_t> data(64uz);
+  std::iota(begin(data), end(data), uint8_t{});
+  std::array<uint8_t, header_size + max_zppwrite_size> buf{};
+  auto const frame{zppwrite2frame(0u, data, buf)};
+  EXPECT_FALSE(*get_flags(frame) & compressed_flag);
+  EXPECT_EQ(size(frame), header_size + zppwrite_size(63u));
+  auto const packet{frame2packet(frame)};
+  ASSERT_TRUE(packet && *packet);
+  EXPECT_TRUE(
+    std::ranges::equal((**packet).subspan(zusi::data_pos, size(data)), data));
+}
+
+TEST(compression, raw_frame_if_same_size) {
+  // Compressed data is 1 byte smaller, which the length byte eats up
+  std::vector<uint8_t> data{0x01u, 0x02u, 0x03u, 0x04u, 0xAAu, 0xAAu, 0xAAu};
+  data.push_back(0xAAu);
+  std::array<uint8_t, header_size + max_zppwrite_size> buf{};
+  auto frame{zppwrite2frame(0u, data, buf)};
+  EXPECT_FALSE(*get_flags(frame) & compressed_flag);
+  EXPECT_EQ(size(frame), header_size + zppwrite_size(7u));
+
+  // One more repeated byte makes the compressed frame smaller
+  data.push_back(0xAAu);
+  frame = zppwrite2frame(0u, data, buf);
+  EXPECT_TRUE(*get_flags(frame) & compressed_flag);
+  EXPECT_LT(size(frame), header_size + zppwrite_size(8u));
+}
+
+TEST(compression, corrupt_compressed_frame) {
+  std::vector<uint8_t> data(256uz, 0x00u);
+  std::array<uint8_t, header_size + max_zppwrite_size> buf{};
+  auto const frame{zppwrite2frame(0u, data, buf)};
+  buf[size(frame) - 2uz] ^= 0x01u;
+  std::array<uint8_t, max_zppwrite_size> packet_buf{};
+  EXPECT_FALSE(frame2packet(frame, packet_buf));
+}
+
+TEST(compression, decoder) {
+  std::vector<uint8_t> data(256uz, 0x42u);
+  std::array<uint8_t, header_size + max_zppwrite_size> buf{};
+  auto frame{zppwrite2frame(0x100u, data, buf)};
+  ASSERT_TRUE(*get_flags(frame) & compressed_flag);
+
+  Decoder decoder;
+  auto const packet{decoder.receive(frame, 0u)};
+  ASSERT_TRUE(packet);
+  ASSERT_TRUE(*packet);
+  EXPECT_EQ(**get_address(**packet), 0x100u);
+  EXPECT_TRUE(
+    std::ranges::equal((**packet).subspan(zusi::data_pos, size(data)), data));
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "ulf/susiv2.hpp"
+#include "ulf/susiv2/cv_cache.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+constexpr uint8_t value(uint32_t addr) {
+  return static_cast<uint8_t>(addr ^ 0x5Au);
+}
+
+// Answer CvRead packets like a decoder would
+zusi::Feedback execute(std::span<uint8_t const> packet) {
+  CvReadView const view{packet};
+  zusi::Feedback::value_type fb;
+  for (auto i{0u}; i <= view.count(); ++i)
+    fb.push_back(value(view.address() + i));
+  return fb;
+}
+
+// Transfer a plain or multi-packet frame and count the CVs read
+struct Receiver {
+  std::vector<uint8_t> operator()(std::span<uint8_t const> frame) {
+    MultiResponse resp;
+    auto const f{[&](std::span<uint8_t const> packet) {
+      cvs += CvReadView{packet}.count() + 1uz;
+      append_response(resp, nak_at == cvs ? zusi::Feedback{std::unexpected{
+                                              std::errc::io_error}}
+                                          : execute(packet));
+    }};
+    if (*get_flags(frame) & multi_flag) EXPECT_TRUE(frame2packets(frame, f));
+    else f(**frame2packet(frame));
+    max_response = std::max(max_response, size(resp));
+    return {std::cbegin(resp), std::cend(resp)};
+  }
+
+  size_t cvs{};
+  size_t max_response{};
+  size_t nak_at{SIZE_MAX};
+};
+
+constexpr std::array<uint8_t, 11uz> cvwrite_packet{
+  0x02u, 0x03u, 0x00u, 0x00u, 0x00u, 0xFFu, 0xAFu, 0xBFu, 0xCFu, 0xDFu, 0xD3u};
+constexpr std::array<uint8_t, 5uz> exit_packet{
+  0x07u, 0x55u, 0xAAu, 0x02u, 0x7Du};
+
+} // namespace
+
+TEST(cv_cache, cvread_packet) {
+  auto const packet{cvread_packet({.addr = 0x1234u, .count = 3u})};
+  EXPECT_TRUE(*validate(packet));
+  CvReadView const view{packet};
+  EXPECT_EQ(view.address(), 0x1234u);
+  EXPECT_EQ(view.count(), 3u);
+}
+
+TEST(cv_cache, plan_cvreads) {
+  std::vector<uint32_t> const addrs{30u, 8u, 1u, 2u, 5u, 3u, 29u, 4u, 2u};
+  EXPECT_EQ(plan_cvreads(addrs, 4uz),
+            (std::vector<CvRange>{{.addr = 1u, .count = 3u},
+                                  {.addr = 5u, .count = 3u},
+                                  {.addr = 29u, .count = 1u}}));
+  EXPECT_EQ(size(plan_cvreads(addrs, 1uz)), 8uz);
+  EXPECT_EQ(size(plan_cvreads(addrs, 256uz)), 1uz);
+
+  // No overflow at the end of the address space
+  std::vector<uint32_t> const high{UINT32_MAX - 1u, UINT32_MAX};
+  EXPECT_EQ(plan_cvreads(high),
+            (std::vector<CvRange>{{.addr = UINT32_MAX - 1u, .count = 1u}}));
+  EXPECT_TRUE(empty(plan_cvreads({})));
+}
+
+TEST(cv_cache, hits_and_misses) {
+  CvCache cache;
+  EXPECT_FALSE(cache.get(8u));
+  std::array<uint8_t, 2uz> const values{145u, 42u};
+  cache.put(7u, values);
+  EXPECT_EQ(cache.get(8u), 42u);
+  EXPECT_EQ(cache.get(7u), 145u);
+  EXPECT_TRUE(cache.contains(7u));
+  EXPECT_EQ(cache.stats().hits, 2uz);
+  EXPECT_EQ(cache.stats().misses, 1uz);
+  EXPECT_EQ(cache.count(), 2uz);
+}
+
+TEST(cv_cache, observe) {
+  CvCache cache;
+
+  // CvRead stores values
+  auto const cvread{cvread_packet({.addr = 0xFEu, .count = 1u})};
+  std::array<uint8_t, 2uz> const read{1u, 2u};
+  cache.observe(cvread, std::span<uint8_t const>{read});
+  EXPECT_EQ(cache.get(0xFFu), 2u);
+
+  // Acknowledged CvWrite writes through
+  cache.observe(cvwrite_packet, std::span<uint8_t const>{});
+  EXPECT_EQ(cache.get(0xFEu), 1u);
+  EXPECT_EQ(cache.get(0xFFu), 0xAFu);
+  EXPECT_EQ(cache.get(0x102u), 0xDFu);
+
+  // Failed CvWrite drops written CVs
+  cache.observe(cvwrite_packet, std::unexpected{std::errc::io_error});
+  EXPECT_EQ(cache.count(), 1uz);
+  EXPECT_EQ(cache.stats().invalidations, 4uz);
+
+  // Exit drops everything
+  cache.observe(exit_packet, std::span<uint8_t const>{});
+  EXPECT_EQ(cache.count(), 0uz);
+  EXPECT_EQ(cache.stats().invalidations, 5uz);
+}
+
+TEST(cv_cache, prefetch_plain) {
+  CvCache cache;
+  Receiver receiver;
+  std::vector<uint32_t> const addrs{1u, 2u, 3u, 7u, 8u, 29u, 30u, 31u, 32u};
+  cache.put(29u, std::array<uint8_t, 1uz>{value(29u)});
+  EXPECT_EQ(cache.prefetch(addrs, std::ref(receiver)), 3uz);
+  for (auto const addr : addrs) EXPECT_EQ(cache.get(addr), value(addr));
+  EXPECT_EQ(cache.stats().misses, 0uz);
+
+  // Everything cached already
+  EXPECT_EQ(cache.prefetch(addrs, std::ref(receiver)), 0uz);
+  EXPECT_EQ(cache.stats().frames, 3uz);
+}
+
+TEST(cv_cache, prefetch_multi) {
+  CvCache cache;
+  Receiver receiver;
+  std::vector<uint32_t> addrs;
+  for (auto i{0u}; i < 100u; ++i) addrs.push_back(i * 3u);
+  EXPECT_EQ(cache.prefetch(addrs, std::ref(receiver), Limits{}), 2uz);
+  EXPECT_EQ(receiver.cvs, 200uz);
+  for (auto const addr : addrs) EXPECT_EQ(cache.get(addr), value(addr));
+
+  // Small response limit splits frames
+  CvCache small;
+  EXPECT_EQ(small.prefetch(addrs,
+                           Receiver{},
+                           Limits{.frame_size = ULF_SUSIV2_MAX_FRAME_SIZE,
+                                  .response_size = 64uz}),
+            5uz);
+  EXPECT_EQ(small.count(), 200uz);
+
+  // Limits too small for a single CvRead
+  EXPECT_EQ(CvCache{}.prefetch(addrs, Receiver{}, Limits{.frame_size = 8uz}),
+            std::unexpected{std::errc::invalid_argument});
+}
+
+TEST(cv_cache, prefetch_multi_responses_within_limits) {
+  std::vector<uint32_t> addrs;
+  for (auto i{0u}; i < 300u; ++i) addrs.push_back(i);
+  for (auto const response_size : {6uz, 16uz, 64uz, 100uz}) {
+    CvCache cache;
+    Receiver receiver;
+    auto const frames{cache.prefetch(
+      addrs,
+      std::ref(receiver),
+      Limits{.frame_size = ULF_SUSIV2_MAX_FRAME_SIZE,
+             .response_size = response_size})};
+    ASSERT_TRUE(frames) << response_size;
+    EXPECT_EQ(cache.count(), size(addrs));
+    EXPECT_LE(receiver.max_response, response_size);
+    // Every CvRead of max_cvread_count CVs takes ack, data and CRC8
+    auto const cvreads{size(addrs) / max_cvread_count};
+    auto const per_frame{response_size / (1uz + max_cvread_count + 1uz)};
+    EXPECT_EQ(*frames, (cvreads + per_frame - 1uz) / per_frame);
+  }
+}
+
+TEST(cv_cache, prefetch_multi_range_exceeds_limits) {
+  // Last CvRead alone needs a larger response than the limits allow
+  CvCache cache;
+  std::vector<uint32_t> addrs{0u};
+  for (auto i{0u}; i < max_cvread_count; ++i) addrs.push_back(100u + i);
+  EXPECT_EQ(cache.prefetch(addrs,
+                           Receiver{},
+                           Limits{.frame_size = ULF_SUSIV2_MAX_FRAME_SIZE,
+                                  .response_size = max_cvread_count}),
+            std::unexpected{std::errc::invalid_argument});
+  EXPECT_EQ(cache.count(), 1uz);
+  EXPECT_FALSE(cache.contains(100u));
+}
+
+TEST(cv_cache, prefetch_nak) {
+  CvCache cache;
+  Receiver receiver{.nak_at = 8uz};
+  std::vector<uint32_t> addrs;
+  for (auto i{0u}; i < 12u; ++i) addrs.push_back(i);
+  EXPECT_EQ(cache.prefetch(addrs, std::ref(receiver)),
+            std::unexpected{std::errc::io_error});
+  EXPECT_EQ(cache.count(), 4uz);
+}
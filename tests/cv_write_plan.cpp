@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <map>
+#include "ulf/susiv2.hpp"
+#include "ulf/susiv2/cv_cache.hpp"
+#include "ulf/susiv2/cv_write_plan.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+// Known values of all CVs in map
+auto known(std::map<uint32_t, uint8_t> const& cvs) {
+  return [&cvs](uint32_t addr) -> std::optional<uint8_t> {
+    if (auto const it{cvs.find(addr)}; it != cend(cvs)) return it->second;
+    return std::nullopt;
+  };
+}
+
+} // namespace
+
+TEST(cv_write_plan, merge_adjacent) {
+  std::vector<CvValue> const cvs{{.addr = 3u, .value = 1u},
+                                 {.addr = 1u, .value = 2u},
+                                 {.addr = 10u, .value = 4u},
+                                 {.addr = 2u, .value = 3u}};
+  auto const plan{plan_cvwrites(cvs)};
+  ASSERT_TRUE(plan);
+  EXPECT_EQ(plan->runs,
+            (std::vector<CvWriteRun>{{.addr = 1u, .values = {2u, 3u, 1u}},
+                                     {.addr = 10u, .values = {4u}}}));
+  EXPECT_EQ(plan->naive_frames, 4uz);
+  EXPECT_EQ(plan->frames(), 2uz);
+  EXPECT_EQ(plan->saved(), 2uz);
+  EXPECT_EQ(plan->bridged, 0uz);
+}
+
+TEST(cv_write_plan, last_value_wins) {
+  std::vector<CvValue> const cvs{{.addr = 5u, .value = 1u},
+                                 {.addr = 6u, .value = 7u},
+                                 {.addr = 5u, .value = 2u}};
+  auto const plan{plan_cvwrites(cvs)};
+  ASSERT_TRUE(plan);
+  EXPECT_EQ(plan->runs,
+            (std::vector<CvWriteRun>{{.addr = 5u, .values = {2u, 7u}}}));
+  EXPECT_EQ(plan->naive_frames, 2uz);
+}
+
+TEST(cv_write_plan, bridge_known_gap) {
+  std::vector<CvValue> const cvs{{.addr = 1u, .value = 10u},
+                                 {.addr = 5u, .value = 50u}};
+  std::map<uint32_t, uint8_t> cache{{2u, 20u}, {3u, 30u}, {4u, 40u}};
+  auto plan{plan_cvwrites(cvs, known(cache))};
+  ASSERT_TRUE(plan);
+  EXPECT_EQ(plan->runs,
+            (std::vector<CvWriteRun>{
+              {.addr = 1u, .values = {10u, 20u, 30u, 40u, 50u}}}));
+  EXPECT_EQ(plan->bridged, 3uz);
+  EXPECT_EQ(plan->saved(), 1uz);
+
+  // Unknown CV in gap
+  cache.erase(3u);
+  plan = plan_cvwrites(cvs, known(cache));
+  ASSERT_TRUE(plan);
+  EXPECT_EQ(plan->frames(), 2uz);
+  EXPECT_EQ(plan->bridged, 0uz);
+}
+
+TEST(cv_write_plan, bridge_only_if_cheaper) {
+  std::map<uint32_t, uint8_t> cache;
+  for (auto i{0u}; i < 100u; ++i) cache[i] = static_cast<uint8_t>(i);
+
+  // Frame overhead (12) + round trip (16) is 28 byte times
+  std::vector<CvValue> const near{{.addr = 0u}, {.addr = 28u}};
+  EXPECT_EQ(plan_cvwrites(near, known(cache))->frames(), 1uz);
+  std::vector<CvValue> const far{{.addr = 0u}, {.addr = 29u}};
+  EXPECT_EQ(plan_cvwrites(far, known(cache))->frames(), 2uz);
+
+  // Slow round trips make bridging more attractive
+  EXPECT_EQ(
+    plan_cvwrites(far, known(cache), {}, {.round_trip = 100uz})->frames(),
+    1uz);
+}
+
+TEST(cv_write_plan, limits) {
+  std::vector<CvValue> cvs;
+  for (auto i{0u}; i < 300u; ++i)
+    cvs.push_back({.addr = 1000u + i, .value = static_cast<uint8_t>(i)});
+
+  auto plan{plan_cvwrites(cvs)};
+  ASSERT_TRUE(plan);
+  ASSERT_EQ(plan->frames(), 2uz);
+  EXPECT_EQ(size(plan->runs[0uz].values), 256uz);
+  EXPECT_EQ(plan->runs[1uz].addr, 1256u);
+  EXPECT_EQ(plan->saved(), 298uz);
+
+  // 8 CVs per frame
+  plan = plan_cvwrites(cvs, Limits{.frame_size = 20uz});
+  ASSERT_TRUE(plan);
+  EXPECT_EQ(plan->frames(), 38uz);
+  for (auto const& run : plan->runs) EXPECT_LE(size(run.values), 8uz);
+
+  EXPECT_EQ(plan_cvwrites(cvs, Limits{.frame_size = 12uz}),
+            std::unexpected{std::errc::invalid_argument});
+}
+
+TEST(cv_write_plan, known_from_cv_cache) {
+  CvCache cache;
+  cache.put(2u, std::array<uint8_t, 2uz>{20u, 30u});
+  std::vector<CvValue> const cvs{{.addr = 1u, .value = 10u},
+                                 {.addr = 4u, .value = 40u}};
+  auto const plan{plan_cvwrites(
+    cvs, [&cache](uint32_t addr) { return cache.peek(addr); })};
+  ASSERT_TRUE(plan);
+  EXPECT_EQ(plan->frames(), 1uz);
+  EXPECT_EQ(cache.stats().hits + cache.stats().misses, 0uz);
+}
+
+TEST(cv_write_plan, cvwrite2frame) {
+  std::array<uint8_t, 4uz> const values{0xAFu, 0xBFu, 0xCFu, 0xDFu};
+  std::array<uint8_t, header_size + max_cvwrite_size> buf;
+  auto const frame{cvwrite2frame(0xFFu, values, buf)};
+  EXPECT_TRUE(std::ranges::equal(
+    frame,
+    std::array<uint8_t, 16uz>{0x00u,
+                              0x00u,
+                              0x00u,
+                              0x00u,
+                              busy_flag,
+                              0x02u,
+                              0x03u,
+                              0x00u,
+                              0x00u,
+                              0x00u,
+                              0xFFu,
+                              0xAFu,
+                              0xBFu,
+                              0xCFu,
+                              0xDFu,
+                              0xD3u}));
+  EXPECT_TRUE(frame2packet(frame) && *frame2packet(frame));
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+constexpr std::array<uint8_t, 12uz> cvread_frame{
+  0x00u, 0x00u, 0x00u, 0x02u, 0x01u, 0x01u, 0x00u, 0x00u, 0x00u, 0x00u, 0xFFu,
+  0x02u};
+constexpr std::array<uint8_t, 16uz> cvwrite_frame{
+  0x00u, 0x00u, 0x00u, 0x00u, 0x01u, 0x02u, 0x03u, 0x00u,
+  0x00u, 0x00u, 0xFFu, 0xAFu, 0xBFu, 0xCFu, 0xDFu, 0xD3u};
+
+} // namespace
+
+TEST(decoder, inter_byte_timeout) {
+  // 3 characters at 115200 baud take ~260.4µs
+  EXPECT_EQ(inter_byte_timeout(115'200u), 261u);
+  EXPECT_EQ(inter_byte_timeout(9600u, 1u), 1042u);
+}
+
+TEST(decoder, complete_frame) {
+  Decoder decoder;
+  std::span<uint8_t const> chunk{cvwrite_frame};
+  auto const packet{decoder.receive(chunk, 0u)};
+  ASSERT_TRUE(packet);
+  ASSERT_TRUE(*packet);
+  EXPECT_TRUE(std::ranges::equal(**packet,
+                                 std::span{cvwrite_frame}.subspan(header_size)));
+  EXPECT_TRUE(empty(chunk));
+}
+
+TEST(decoder, byte_by_byte) {
+  Decoder decoder;
+  for (auto i{0uz}; i < size(cvread_frame) - 1uz; ++i) {
+    auto const packet{
+      decoder.receive({&cvread_frame[i], 1uz}, static_cast<uint32_t>(i))};
+    ASSERT_TRUE(packet);
+    ASSERT_FALSE(*packet);
+  }
+  auto const packet{decoder.receive({&cvread_frame.back(), 1uz}, 0u)};
+  ASSERT_TRUE(packet);
+  ASSERT_TRUE(*packet);
+  EXPECT_EQ(size(**packet), cvread_size);
+}
+
+TEST(decoder, consecutive_frames_in_one_chunk) {
+  Decoder decoder;
+  std::vector<uint8_t> stream{cbegin(cvread_frame), cend(cvread_frame)};
+  std::ranges::copy(cvwrite_frame, std::back_inserter(stream));
+  std::span<uint8_t const> chunk{stream};
+
+  auto packet{decoder.receive(chunk, 0u)};
+  ASSERT_TRUE(packet && *packet);
+  EXPECT_EQ(size(**packet), cvread_size);
+  EXPECT_EQ(size(chunk), size(cvwrite_frame));
+
+  packet = decoder.receive(chunk, 0u);
+  ASSERT_TRUE(packet && *packet);
+  EXPECT_EQ(size(**packet), cvwrite_size(0x03u));
+  EXPECT_TRUE(empty(chunk));
+}
+
+TEST(decoder, stale_partial_frame_times_out) {
+  Decoder decoder{inter_byte_timeout(115'200u)};
+
+  // Host died mid-frame
+  auto packet{decoder.receive(std::span{cvwrite_frame}.first(7uz), 1000u)};
+  ASSERT_TRUE(packet);
+  ASSERT_FALSE(*packet);
+  EXPECT_EQ(decoder.pending(), 7uz);
+
+  // Next frame arrives after the gap and is accepted right away
+  packet = decoder.receive(cvread_frame, 1000u + decoder.timeout() + 1u);
+  ASSERT_TRUE(packet);
+  ASSERT_TRUE(*packet);
+  EXPECT_EQ(decoder.dropped(), 7uz);
+}
+
+TEST(decoder, gap_within_timeout_continues_frame) {
+  Decoder decoder{inter_byte_timeout(115'200u)};
+  std::span<uint8_t const> frame{cvwrite_frame};
+  ASSERT_FALSE(*decoder.receive(frame.first(7uz), 1000u));
+  auto const packet{
+    decoder.receive(frame.subspan(7uz), 1000u + decoder.timeout())};
+  ASSERT_TRUE(packet);
+  ASSERT_TRUE(*packet);
+  EXPECT_EQ(decoder.dropped(), 0uz);
+}
+
+TEST(decoder, corrupt_frame_is_dropped) {
+  Decoder decoder;
+  auto corrupt{cvread_frame};
+  corrupt.back() = 0xFFu;
+  EXPECT_FALSE(decoder.receive(corrupt, 0u));
+  EXPECT_EQ(decoder.dropped(), size(corrupt));
+  EXPECT_EQ(decoder.pending(), 0uz);
+
+  // Resumes with the next byte
+  auto const packet{decoder.receive(cvread_frame, 0u)};
+  ASSERT_TRUE(packet);
+  ASSERT_TRUE(*packet);
+}
+
+TEST(decoder, unknown_command_is_dropped) {
+  Decoder decoder;
+  std::array<uint8_t, 6uz> frame{0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u};
+  std::span<uint8_t const> chunk{frame};
+  EXPECT_FALSE(decoder.receive(chunk, 0u));
+  EXPECT_EQ(decoder.dropped(), size(frame));
+}
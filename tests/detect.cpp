@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string_view>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+constexpr std::array<uint8_t, 12uz> cvread_frame{
+  0x00u, 0x00u, 0x00u, 0x02u, 0x01u, 0x01u, 0x00u, 0x00u, 0x00u, 0x00u, 0xFFu,
+  0x02u};
+constexpr std::array<uint8_t, 10uz> exit_frame{
+  0x00u, 0x00u, 0x00u, 0x00u, 0x01u, 0x07u, 0x55u, 0xAAu, 0x02u, 0x7Du};
+
+// Confidence of each prefix of a frame
+std::vector<Confidence> prefixes(std::span<uint8_t const> frame) {
+  std::vector<Confidence> v;
+  for (auto i{0uz}; i <= size(frame); ++i) v.push_back(detect(frame.first(i)));
+  return v;
+}
+
+} // namespace
+
+TEST(detect, prefixes_of_valid_frame) {
+  auto const v{prefixes(cvread_frame)};
+  for (auto i{0uz}; i <= 5uz; ++i) EXPECT_EQ(v[i], Confidence::Low);
+  for (auto i{6uz}; i < size(cvread_frame); ++i)
+    EXPECT_EQ(v[i], Confidence::Medium);
+  EXPECT_EQ(v.back(), Confidence::High);
+  EXPECT_TRUE(std::ranges::is_sorted(v));
+}
+
+TEST(detect, frame_kinds) {
+  EXPECT_EQ(detect(exit_frame), Confidence::High);
+
+  // Multi-packet
+  MultiFrame multi;
+  multi.push_back(std::span{exit_frame}.subspan(header_size), 0u, true);
+  EXPECT_EQ(detect(multi.frame()), Confidence::High);
+
+  // Sequenced
+  std::vector<uint8_t> sequenced{cbegin(cvread_frame), cend(cvread_frame)};
+  sequenced[flags_pos] |= sequence_flag;
+  sequenced.insert(cbegin(sequenced) + sequence_pos, 42u);
+  EXPECT_EQ(detect(sequenced), Confidence::High);
+
+  // Compressed
+  std::array<uint8_t, 256uz> const data{};
+  std::array<uint8_t, header_size + max_zppwrite_size> buf;
+  auto const compressed{zppwrite2frame(0u, data, buf)};
+  ASSERT_TRUE(compressed[flags_pos] & compressed_flag);
+  EXPECT_EQ(detect(compressed), Confidence::High);
+}
+
+TEST(detect, contradictions) {
+  // CRC8
+  auto corrupt{cvread_frame};
+  corrupt.back() ^= 0x01u;
+  EXPECT_EQ(detect(corrupt), Confidence::None);
+
+  // Answer length too large for a response
+  auto too_long{cvread_frame};
+  too_long[3uz] = 0x10u;
+  EXPECT_EQ(detect(too_long), Confidence::None);
+
+  // Unknown flag
+  auto flags{cvread_frame};
+  flags[flags_pos] = 0x80u;
+  EXPECT_EQ(detect(std::span{flags}.first(5uz)), Confidence::None);
+
+  // Valid command without known packet size (Encrypt)
+  auto encrypt{cvread_frame};
+  encrypt[5uz] = 0x08u;
+  EXPECT_EQ(detect(std::span{encrypt}.first(6uz)), Confidence::None);
+  EXPECT_EQ(detect(encrypt), Confidence::None);
+
+  // Security bytes
+  auto exit{exit_frame};
+  exit[7uz] = 0x00u;
+  EXPECT_EQ(detect(std::span{exit}.first(8uz)), Confidence::None);
+
+  // Idle line
+  std::array<uint8_t, 6uz> const zeros{};
+  EXPECT_EQ(detect(zeros), Confidence::None);
+}
+
+TEST(detect, text_fails_on_first_byte) {
+  for (std::string_view const text : {"DCC_EIN\r", "x", "\x01\x02"}) {
+    std::span const bytes{reinterpret_cast<uint8_t const*>(data(text)),
+                          size(text)};
+    EXPECT_EQ(detect(bytes.first(1uz)), Confidence::None) << text;
+  }
+}
+
+TEST(detect, false_positive_rate) {
+  std::mt19937 gen{42u};
+  std::uniform_int_distribution<uint32_t> dist{0u, 255u};
+  std::array<uint8_t, 16uz> bytes;
+  size_t positives{};
+  for (auto i{0uz}; i < 100'000uz; ++i) {
+    std::ranges::generate(bytes,
+                          [&] { return static_cast<uint8_t>(dist(gen)); });
+    positives += detect(bytes) >= Confidence::Low;
+  }
+  EXPECT_EQ(positives, 0uz);
+}
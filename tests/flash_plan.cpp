@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "ulf/susiv2/flash_plan.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+constexpr FlashGeometry geometry{.size = 64u * 1024u};
+
+// Image of 4 pages, third one blank
+std::vector<uint8_t> make_image() {
+  std::vector<uint8_t> image(1024uz);
+  for (auto i{0uz}; i < size(image); ++i)
+    image[i] = static_cast<uint8_t>(i / 256uz == 2uz ? flash_erased : i);
+  return image;
+}
+
+// Chunks start on page boundaries (256 byte boundaries within larger pages) or
+// at the image and don't cross sectors
+void expect_aligned(FlashPlan const& plan,
+                    uint32_t addr,
+                    FlashGeometry const& g) {
+  for (auto const& chunk : plan.chunks) {
+    EXPECT_GE(chunk.size, 1u);
+    EXPECT_LE(chunk.size, 256u);
+    EXPECT_TRUE(!(chunk.addr % g.page_size % 256u) ||
+                chunk.addr == addr);
+    EXPECT_EQ(chunk.addr / g.sector_size,
+              (chunk.addr + chunk.size - 1u) / g.sector_size);
+    EXPECT_EQ(chunk.addr, addr + chunk.offset);
+  }
+}
+
+} // namespace
+
+TEST(flash_plan, unknown_content) {
+  auto const image{make_image()};
+  auto const plan{plan_flash(image, 0x1000u, geometry)};
+  ASSERT_TRUE(plan);
+  EXPECT_TRUE(plan->erase);
+  EXPECT_EQ(plan->chunks,
+            (std::vector<FlashChunk>{
+              {.addr = 0x1000u, .offset = 0u, .size = 256u},
+              {.addr = 0x1100u, .offset = 256u, .size = 256u},
+              {.addr = 0x1300u, .offset = 768u, .size = 256u}}));
+  EXPECT_EQ(plan->busy_us, 16u * 45'000u + 3u * 700u);
+}
+
+TEST(flash_plan, unchanged) {
+  auto const image{make_image()};
+  auto const plan{plan_flash(image, 0x1000u, geometry, image)};
+  ASSERT_TRUE(plan);
+  EXPECT_FALSE(plan->erase);
+  EXPECT_TRUE(empty(plan->chunks));
+  EXPECT_EQ(plan->busy_us, 0u);
+}
+
+TEST(flash_plan, clear_bits_only) {
+  auto const current{make_image()};
+  auto image{current};
+  image[300uz] &= 0x0Fu;
+  image[600uz] = 0x00u;
+  auto const plan{plan_flash(image, 0x1000u, geometry, current)};
+  ASSERT_TRUE(plan);
+  EXPECT_FALSE(plan->erase);
+  EXPECT_EQ(plan->chunks,
+            (std::vector<FlashChunk>{
+              {.addr = 0x1100u, .offset = 256u, .size = 256u},
+              {.addr = 0x1200u, .offset = 512u, .size = 256u}}));
+  EXPECT_EQ(plan->busy_us, 2u * 700u);
+}
+
+TEST(flash_plan, set_bits_needs_erase) {
+  auto const current{make_image()};
+  auto image{current};
+  image[1uz] = 0xFEu;
+  auto const plan{plan_flash(image, 0x1000u, geometry, current)};
+  ASSERT_TRUE(plan);
+  EXPECT_TRUE(plan->erase);
+  EXPECT_EQ(size(plan->chunks), 3uz);
+}
+
+TEST(flash_plan, small_pages) {
+  FlashGeometry const g{.size = 4096u, .sector_size = 256u, .page_size = 64u};
+  std::vector<uint8_t> const image(600uz, 0x00u);
+  auto const plan{plan_flash(image, 32u, g)};
+  ASSERT_TRUE(plan);
+  expect_aligned(*plan, 32u, g);
+  EXPECT_EQ(plan->chunks,
+            (std::vector<FlashChunk>{
+              {.addr = 32u, .offset = 0u, .size = 224u},
+              {.addr = 256u, .offset = 224u, .size = 256u},
+              {.addr = 512u, .offset = 480u, .size = 120u}}));
+  EXPECT_EQ(plan->busy_us, 16u * 45'000u + 10u * 700u);
+}
+
+TEST(flash_plan, large_pages) {
+  FlashGeometry const g{.size = 8192u, .page_size = 512u};
+  std::vector<uint8_t> const image(1024uz, 0x00u);
+  auto const plan{plan_flash(image, 0u, g, std::nullopt, {})};
+  ASSERT_TRUE(plan);
+  expect_aligned(*plan, 0u, g);
+  EXPECT_EQ(size(plan->chunks), 4uz);
+}
+
+TEST(flash_plan, invalid) {
+  auto const image{make_image()};
+  EXPECT_FALSE(plan_flash(image, 0u, {.size = 4096u, .page_size = 0u}));
+  EXPECT_FALSE(
+    plan_flash(image, 0u, {.size = 4096u, .sector_size = 1000u}));
+  EXPECT_FALSE(plan_flash(image, 0u, geometry, std::span{image}.first(10uz)));
+  EXPECT_FALSE(plan_flash(image, 64u * 1024u - 10u, geometry));
+}
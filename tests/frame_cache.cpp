@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+#include "ulf/susiv2.hpp"
+#include "ulf/susiv2/frame_cache.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+std::vector<uint8_t> make_image(size_t size) {
+  std::vector<uint8_t> image(size, 0xFFu);
+  std::iota(begin(image), begin(image) + static_cast<ptrdiff_t>(size / 2uz),
+            uint8_t{});
+  return image;
+}
+
+std::vector<uint8_t> build(std::span<uint8_t const> image,
+                           FrameCacheKey const& key,
+                           size_t threads) {
+  std::vector<uint8_t> cache(frame_cache_max_size(key));
+  auto const n{build_frame_cache(image, key, cache, threads)};
+  EXPECT_TRUE(n);
+  cache.resize(n ? *n : 0uz);
+  return cache;
+}
+
+} // namespace
+
+TEST(frame_cache, fnv1a) {
+  EXPECT_EQ(fnv1a({}), 0xCBF2'9CE4'8422'2325u);
+  std::array<uint8_t, 1uz> const a{'a'};
+  EXPECT_EQ(fnv1a(a), 0xAF63'DC4C'8601'EC8Cu);
+}
+
+TEST(frame_cache, frames_match_image) {
+  auto const image{make_image(1000uz)};
+  auto const key{make_frame_cache_key(image, 0x100u, 128u)};
+  auto const cache{build(image, key, 1uz)};
+  auto const view{read_frame_cache(cache, key)};
+  ASSERT_TRUE(view);
+  ASSERT_EQ(view->count(), 8uz);
+
+  size_t stream_size{};
+  for (auto i{0uz}; i < view->count(); ++i) {
+    auto const frame{(*view)[i]};
+    stream_size += size(frame);
+    auto const packet{frame2packet(frame)};
+    ASSERT_TRUE(packet && *packet);
+    EXPECT_EQ(**get_address(**packet), 0x100u + i * 128u);
+    auto const n{std::min(128uz, size(image) - i * 128uz)};
+    EXPECT_EQ(size(**packet), zppwrite_size(static_cast<uint8_t>(n - 1uz)));
+    EXPECT_TRUE(
+      std::ranges::equal((**packet).subspan(zusi::data_pos, n),
+                         std::span{image}.subspan(i * 128uz, n)));
+  }
+  EXPECT_EQ(size(view->stream()), stream_size);
+}
+
+TEST(frame_cache, parallel_build_is_identical) {
+  auto const image{make_image(64uz * 1024uz + 17uz)};
+  auto const key{make_frame_cache_key(image, 0u, 256u, true)};
+  auto const cache{build(image, key, 1uz)};
+  EXPECT_EQ(build(image, key, 3uz), cache);
+  EXPECT_EQ(build(image, key, 0uz), cache);
+
+  // Compressible half of the image is smaller than raw frames
+  EXPECT_LT(size(cache), frame_cache_max_size(key));
+  auto const view{read_frame_cache(cache, key)};
+  ASSERT_TRUE(view);
+  std::array<uint8_t, max_zppwrite_size> buf{};
+  auto const packet{frame2packet((*view)[view->count() - 2uz], buf)};
+  ASSERT_TRUE(packet && *packet);
+  EXPECT_EQ((**packet)[zusi::data_pos], 0xFFu);
+}
+
+TEST(frame_cache, stale) {
+  auto image{make_image(1000uz)};
+  auto const key{make_frame_cache_key(image, 0u)};
+  auto const cache{build(image, key, 2uz)};
+
+  image[500uz] ^= 0x01u;
+  EXPECT_EQ(read_frame_cache(cache, make_frame_cache_key(image, 0u)).error(),
+            std::errc::invalid_argument);
+  EXPECT_FALSE(read_frame_cache(cache, make_frame_cache_key(image, 0u, 128u)));
+  EXPECT_FALSE(read_frame_cache(cache, make_frame_cache_key(image, 4u)));
+}
+
+TEST(frame_cache, corrupt) {
+  auto const image{make_image(1000uz)};
+  auto const key{make_frame_cache_key(image, 0u)};
+  auto cache{build(image, key, 2uz)};
+
+  // Truncated
+  EXPECT_EQ(
+    read_frame_cache(std::span{cache}.first(size(cache) - 1uz), key).error(),
+    std::errc::protocol_error);
+
+  // Index not ascending
+  std::ranges::fill_n(&cache[frame_cache_header_size + 4uz], 4, 0xFFu);
+  EXPECT_EQ(read_frame_cache(cache, key).error(), std::errc::protocol_error);
+
+  // Wrong magic
+  cache[0uz] = 'X';
+  EXPECT_EQ(read_frame_cache(cache, key).error(), std::errc::protocol_error);
+}
+
+TEST(frame_cache, buffer_too_small) {
+  auto const image{make_image(1000uz)};
+  auto const key{make_frame_cache_key(image, 0u)};
+  std::vector<uint8_t> cache(frame_cache_max_size(key) - 1uz);
+  EXPECT_FALSE(build_frame_cache(image, key, cache));
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <zusi/crc8.hpp>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+std::vector<uint8_t> make_frame(zusi::Command cmd,
+                                uint8_t cnt,
+                                uint32_t addr,
+                                std::span<uint8_t const> bytes,
+                                uint32_t answer_length,
+                                bool busy) {
+  std::vector<uint8_t> frame(header_size);
+  uint32_2data(answer_length, data(frame));
+  frame[flags_pos] = busy ? busy_flag : 0u;
+  std::vector<uint8_t> packet{std::to_underlying(cmd), cnt, 0u, 0u, 0u, 0u};
+  uint32_2data(addr, &packet[zusi::addr_pos]);
+  std::ranges::copy(bytes, std::back_inserter(packet));
+  packet.push_back(zusi::crc8(packet));
+  std::ranges::copy(packet, std::back_inserter(frame));
+  return frame;
+}
+
+} // namespace
+
+TEST(frame_template, cvread) {
+  FrameTemplate tmpl{zusi::Command::CvRead, 0u, 2u, false};
+  for (auto addr : {0u, 1u, 28u, 1023u}) {
+    tmpl.address(addr);
+    EXPECT_TRUE(std::ranges::equal(
+      tmpl.frame(), make_frame(zusi::Command::CvRead, 0u, addr, {}, 2u, false)));
+    auto const packet{frame2packet(tmpl.frame())};
+    ASSERT_TRUE(packet && *packet);
+  }
+}
+
+TEST(frame_template, cvwrite_address_only) {
+  std::array<uint8_t, 1uz> value{42u};
+  FrameTemplate tmpl{zusi::Command::CvWrite, 0u, 0u, true};
+  tmpl.data(value);
+  for (auto addr : {7u, 8u, 0xFFFF'FFFFu}) {
+    tmpl.address(addr);
+    EXPECT_TRUE(std::ranges::equal(
+      tmpl.frame(),
+      make_frame(zusi::Command::CvWrite, 0u, addr, value, 0u, true)));
+  }
+}
+
+TEST(frame_template, zppwrite) {
+  std::vector<uint8_t> chunk(256uz);
+  FrameTemplate tmpl{zusi::Command::ZppWrite, 0xFFu, 0u, true};
+  for (auto i{0u}; i < 8u; ++i) {
+    std::ranges::generate(chunk, [n = i]() mutable {
+      return static_cast<uint8_t>(n++ * 31u);
+    });
+    tmpl.address(i * 256u).data(chunk);
+    EXPECT_TRUE(std::ranges::equal(
+      tmpl.frame(),
+      make_frame(zusi::Command::ZppWrite, 0xFFu, i * 256u, chunk, 0u, true)));
+    EXPECT_TRUE(std::ranges::equal(tmpl.packet(), **frame2packet(tmpl.frame())));
+  }
+}
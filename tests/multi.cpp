@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+std::vector<uint8_t> cvwrite_packet(uint32_t addr, uint8_t value) {
+  std::vector<uint8_t> packet{0x02u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, value};
+  uint32_2data(addr, &packet[zusi::addr_pos]);
+  packet.push_back(zusi::crc8(packet));
+  return packet;
+}
+
+std::vector<uint8_t> cvread_packet(uint32_t addr) {
+  std::vector<uint8_t> packet{0x01u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u};
+  uint32_2data(addr, &packet[zusi::addr_pos]);
+  packet.push_back(zusi::crc8(packet));
+  return packet;
+}
+
+} // namespace
+
+TEST(multi, frame2packets) {
+  MultiFrame multi;
+  ASSERT_TRUE(multi.push_back(cvwrite_packet(7u, 0x10u), 0u, true));
+  ASSERT_TRUE(multi.push_back(cvread_packet(8u), 1u, false));
+  ASSERT_TRUE(multi.push_back(cvwrite_packet(9u, 0x30u), 0u, true));
+  EXPECT_EQ(multi.count(), 3uz);
+  EXPECT_EQ(multi.response_size(), 5uz);
+  EXPECT_EQ(*get_answer_length(multi.frame()), 1u);
+  EXPECT_TRUE(*get_flags(multi.frame()) & busy_flag);
+
+  std::vector<std::vector<uint8_t>> packets;
+  auto const count{frame2packets(multi.frame(), [&](auto packet) {
+    packets.emplace_back(cbegin(packet), cend(packet));
+  })};
+  ASSERT_TRUE(count);
+  ASSERT_TRUE(*count);
+  EXPECT_EQ(**count, 3uz);
+  ASSERT_EQ(size(packets), 3uz);
+  EXPECT_EQ(packets[0uz], cvwrite_packet(7u, 0x10u));
+  EXPECT_EQ(packets[1uz], cvread_packet(8u));
+  EXPECT_EQ(packets[2uz], cvwrite_packet(9u, 0x30u));
+
+  // Plain frame2packet doesn't know about multi-packet frames
+  EXPECT_EQ(frame2packet(multi.frame()).error(), std::errc::not_supported);
+}
+
+TEST(multi, incomplete_and_corrupt) {
+  MultiFrame multi;
+  multi.push_back(cvwrite_packet(7u, 0x10u), 0u, true);
+  multi.push_back(cvwrite_packet(8u, 0x20u), 0u, true);
+  auto const frame{multi.frame()};
+
+  size_t calls{};
+  auto const f{[&](auto) { ++calls; }};
+  auto const incomplete{frame2packets(frame.first(size(frame) - 1uz), f)};
+  ASSERT_TRUE(incomplete);
+  EXPECT_FALSE(*incomplete);
+
+  // No packet is passed on if any of them is corrupt
+  std::vector<uint8_t> corrupt{cbegin(frame), cend(frame)};
+  corrupt.back() ^= 0xFFu;
+  EXPECT_FALSE(frame2packets(corrupt, f));
+  EXPECT_EQ(calls, 0uz);
+}
+
+TEST(multi, limits) {
+  EXPECT_EQ(negotiate({64uz, 16uz}, {}).frame_size, 64uz);
+  EXPECT_EQ(negotiate({64uz, 16uz}, {}).response_size, 16uz);
+
+  // Frame limit
+  MultiFrame small_frame{{.frame_size = multi_header_size + 16uz}};
+  EXPECT_TRUE(small_frame.push_back(cvwrite_packet(1u, 0u), 0u, true));
+  EXPECT_TRUE(small_frame.push_back(cvwrite_packet(2u, 0u), 0u, true));
+  EXPECT_FALSE(small_frame.push_back(cvwrite_packet(3u, 0u), 0u, true));
+
+  // Response limit
+  MultiFrame small_response{{.response_size = 6uz}};
+  EXPECT_TRUE(small_response.push_back(cvread_packet(1u), 1u, false));
+  EXPECT_TRUE(small_response.push_back(cvread_packet(2u), 1u, false));
+  EXPECT_FALSE(small_response.push_back(cvread_packet(3u), 1u, false));
+}
+
+TEST(multi, response_size_matches_aggregated_response) {
+  MultiFrame multi{{.response_size = 64uz}};
+  std::vector<uint8_t> cvread(cvread_packet(0u));
+  cvread[zusi::data_cnt_pos] = 3u;
+  cvread.back() = zusi::crc8(std::span{cvread}.first(size(cvread) - 1uz));
+  while (multi.push_back(cvread, 4u, false)) continue;
+  multi.push_back(cvwrite_packet(1u, 0u), 0u, true);
+
+  MultiResponse resp;
+  auto const count{frame2packets(multi.frame(), [&](auto packet) {
+    zusi::Feedback::value_type fb;
+    if (packet[zusi::cmd_pos] == std::to_underlying(zusi::Command::CvRead))
+      for (auto i{0uz}; i <= packet[zusi::data_cnt_pos]; ++i) fb.push_back(0u);
+    append_response(resp, fb);
+  })};
+  ASSERT_TRUE(count && *count);
+  EXPECT_EQ(multi.response_size(), size(resp));
+  EXPECT_LE(size(resp), 64uz);
+  // 10 CvReads of 4 CVs (6 bytes each) and a CvWrite (1 byte)
+  EXPECT_EQ(**count, 11uz);
+}
+
+TEST(multi, aggregated_response) {
+  MultiResponse resp;
+  EXPECT_TRUE(append_response(resp, zusi::Feedback{}));
+  EXPECT_TRUE(append_response(resp, zusi::Feedback{{42u}}));
+  EXPECT_TRUE(
+    append_response(resp, zusi::Feedback{std::unexpected{std::errc{}}}));
+  EXPECT_EQ(resp, (MultiResponse{ack, ack, 42u, zusi::crc8(42u), nak}));
+}
+
+TEST(multi, decoder) {
+  MultiFrame multi;
+  for (auto addr{0u}; addr < 4u; ++addr)
+    multi.push_back(cvwrite_packet(addr, static_cast<uint8_t>(addr)), 0u, true);
+  std::vector<uint8_t> stream{cbegin(multi.frame()), cend(multi.frame())};
+  stream.push_back(0xAAu); // Start of next frame
+
+  Decoder decoder;
+  std::span<uint8_t const> chunk{stream};
+  for (auto addr{0u}; addr < 4u; ++addr) {
+    auto const packet{decoder.receive(chunk, 0u)};
+    ASSERT_TRUE(packet);
+    ASSERT_TRUE(*packet);
+    EXPECT_EQ(**get_address(**packet), addr);
+    EXPECT_TRUE(decoder.multi());
+    EXPECT_EQ(decoder.remaining(), 3uz - addr);
+  }
+  EXPECT_EQ(size(chunk), 1uz);
+}
+
+TEST(multi, decoder_byte_by_byte) {
+  MultiFrame multi;
+  multi.push_back(cvwrite_packet(1u, 1u), 0u, true);
+  multi.push_back(cvread_packet(2u), 1u, false);
+  auto const frame{multi.frame()};
+
+  Decoder decoder;
+  for (auto i{0uz}; i < size(frame) - 1uz; ++i)
+    ASSERT_FALSE(*decoder.receive({&frame[i], 1uz}, 0u));
+  auto packet{decoder.receive({&frame.back(), 1uz}, 0u)};
+  ASSERT_TRUE(packet && *packet);
+  EXPECT_EQ(**get_command(**packet), zusi::Command::CvWrite);
+  packet = decoder.receive({}, 0u);
+  ASSERT_TRUE(packet && *packet);
+  EXPECT_EQ(**get_command(**packet), zusi::Command::CvRead);
+  EXPECT_EQ(decoder.remaining(), 0uz);
+}
+
+TEST(multi, configuration_write_round_trips) {
+  // 500 CVs take a fraction of the round trips
+  size_t frames{};
+  MultiFrame multi;
+  for (auto addr{0u}; addr < 500u; ++addr) {
+    auto const packet{cvwrite_packet(addr, 0u)};
+    if (!multi.push_back(packet, 0u, true)) {
+      ++frames;
+      multi.clear();
+      multi.push_back(packet, 0u, true);
+    }
+  }
+  ++frames;
+  EXPECT_LT(frames, 50uz);
+}
+
+TEST(multi, decoder_oversized_frame) {
+  // First packet alone already exceeds the buffer
+  std::vector<uint8_t> frame{0x00u, 0x00u, 0x00u, 0x00u, multi_flag, 2u};
+  frame.push_back(std::to_underlying(zusi::Command::ZppWrite));
+  frame.push_back(0xFFu);
+  frame.resize(ULF_SUSIV2_MAX_FRAME_SIZE + 8uz, 0xAAu);
+
+  Decoder decoder;
+  auto i{0uz};
+  Decoder::result_type packet{std::nullopt};
+  for (; i < size(frame) && packet && !*packet; ++i)
+    packet = decoder.receive({&frame[i], 1uz}, 0u);
+  ASSERT_FALSE(packet);
+  EXPECT_EQ(packet.error(), std::errc::message_size);
+  EXPECT_EQ(decoder.dropped(), i);
+  EXPECT_EQ(decoder.pending(), 0uz);
+}
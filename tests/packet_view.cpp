@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <string_view>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+template<typename... Ts>
+struct Overloaded : Ts... {
+  using Ts::operator()...;
+};
+
+constexpr std::array<uint8_t, 11uz> cvwrite_packet{
+  0x02u, 0x03u, 0x00u, 0x00u, 0x00u, 0xFFu, 0xAFu, 0xBFu, 0xCFu, 0xDFu, 0xD3u};
+constexpr std::array<uint8_t, 5uz> exit_packet{
+  0x07u, 0x55u, 0xAAu, 0x02u, 0x7Du};
+
+} // namespace
+
+TEST(packet_view, cvwrite) {
+  std::span<uint8_t const> const packet{cvwrite_packet};
+  ASSERT_TRUE(*validate(packet));
+  CvWriteView const view{packet};
+  EXPECT_EQ(view.count(), 3u);
+  EXPECT_EQ(view.address(), 0xFFu);
+  EXPECT_TRUE(std::ranges::equal(view.data(), packet.subspan(6uz, 4uz)));
+  EXPECT_EQ(view.count(), **get_count(packet));
+  EXPECT_EQ(view.address(), **get_address(packet));
+}
+
+TEST(packet_view, exit) {
+  ExitView const view{exit_packet};
+  EXPECT_EQ(view.flags(), **get_exit_flags(exit_packet));
+}
+
+TEST(packet_view, visit_packet) {
+  auto const f{Overloaded{
+    [](CvWriteView view) { return view.address(); },
+    [](ExitView view) -> uint32_t { return view.flags(); },
+    [](auto) { return UINT32_MAX; },
+  }};
+  EXPECT_EQ(visit_packet(f, cvwrite_packet), 0xFFu);
+  EXPECT_EQ(visit_packet(f, exit_packet), 0x02u);
+
+  std::array<uint8_t, 2uz> const features{0x06u, 0x00u};
+  EXPECT_EQ(visit_packet(f, features), UINT32_MAX);
+}
+
+TEST(packet_view, from_decoder) {
+  std::vector<uint8_t> frame{0x00u, 0x00u, 0x00u, 0x00u, 0x01u};
+  frame.insert(end(frame), begin(exit_packet), end(exit_packet));
+  Decoder decoder;
+  auto const packet{decoder.receive(frame, 0u)};
+  ASSERT_TRUE(packet && *packet);
+  auto const name{visit_packet(
+    []<typename View>(View) -> std::string_view {
+      if constexpr (View::command == zusi::Command::Exit) return "exit";
+      else return "other";
+    },
+    **packet)};
+  EXPECT_EQ(name, "exit");
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <list>
+#include <sstream>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+constexpr std::array<uint8_t, 12uz> cvread_frame{
+  0x00u, 0x00u, 0x00u, 0x02u, 0x01u, 0x01u, 0x00u, 0x00u, 0x00u, 0x00u, 0xFFu,
+  0x02u};
+constexpr std::array<uint8_t, 16uz> cvwrite_frame{
+  0x00u, 0x00u, 0x00u, 0x00u, 0x01u, 0x02u, 0x03u, 0x00u,
+  0x00u, 0x00u, 0xFFu, 0xAFu, 0xBFu, 0xCFu, 0xDFu, 0xD3u};
+
+// cvread, cvwrite, corrupt cvread, cvwrite
+std::vector<uint8_t> make_stream() {
+  std::vector<uint8_t> stream{cbegin(cvread_frame), cend(cvread_frame)};
+  stream.insert(cend(stream), cbegin(cvwrite_frame), cend(cvwrite_frame));
+  stream.insert(cend(stream), cbegin(cvread_frame), cend(cvread_frame));
+  stream[size(stream) - 1uz] ^= 0xFFu;
+  stream.insert(cend(stream), cbegin(cvwrite_frame), cend(cvwrite_frame));
+  return stream;
+}
+
+// Commands of packets, 0 for errors
+template<std::ranges::input_range R>
+std::vector<uint8_t> commands(R&& r) {
+  std::vector<uint8_t> cmds;
+  for (auto const& packet : r)
+    cmds.push_back(packet ? (*packet)[zusi::cmd_pos] : 0u);
+  return cmds;
+}
+
+std::vector<uint8_t> const expected{0x01u, 0x02u, 0x00u, 0x02u};
+
+} // namespace
+
+TEST(packets_view, contiguous) {
+  auto const stream{make_stream()};
+  EXPECT_EQ(commands(stream | views::packets), expected);
+
+  // Packets point into the decoder, not the stream
+  for (auto const& packet : views::packets(stream)) {
+    ASSERT_TRUE(packet);
+    EXPECT_TRUE(std::ranges::equal(
+      *packet, std::span{cvread_frame}.subspan(header_size)));
+    break;
+  }
+}
+
+TEST(packets_view, bytes) {
+  auto const stream{make_stream()};
+  std::list<uint8_t> const list{cbegin(stream), cend(stream)};
+  EXPECT_EQ(commands(list | views::packets), expected);
+
+  // Single pass input
+  std::istringstream is{std::string{cbegin(stream), cend(stream)}};
+  EXPECT_EQ(commands(std::ranges::subrange{std::istreambuf_iterator<char>{is},
+                                           std::istreambuf_iterator<char>{}} |
+                     views::packets),
+            expected);
+}
+
+TEST(packets_view, chunks) {
+  auto const stream{make_stream()};
+  std::vector<std::vector<uint8_t>> chunks;
+  for (auto i{0uz}; i < size(stream); i += 7uz)
+    chunks.emplace_back(cbegin(stream) + static_cast<ptrdiff_t>(i),
+                        cbegin(stream) + static_cast<ptrdiff_t>(std::min(
+                                           i + 7uz, size(stream))));
+  EXPECT_EQ(commands(chunks | views::packets), expected);
+
+  std::vector<std::span<uint8_t const>> spans{std::span{stream}.first(3uz),
+                                              std::span{stream}.subspan(3uz)};
+  EXPECT_EQ(commands(spans | views::packets), expected);
+}
+
+TEST(packets_view, multi) {
+  MultiFrame multi;
+  multi.push_back(std::span{cvread_frame}.subspan(header_size), 1u, true);
+  multi.push_back(std::span{cvwrite_frame}.subspan(header_size), 0u, true);
+  std::vector<uint8_t> stream{cbegin(multi.frame()), cend(multi.frame())};
+  stream.insert(cend(stream), cbegin(cvread_frame), cend(cvread_frame));
+  EXPECT_EQ(commands(stream | views::packets),
+            (std::vector<uint8_t>{0x01u, 0x02u, 0x01u}));
+}
+
+TEST(packets_view, partial_frame_at_end_is_dropped) {
+  std::vector<uint8_t> stream{cbegin(cvread_frame), cend(cvread_frame)};
+  stream.insert(cend(stream), cbegin(cvwrite_frame), cend(cvwrite_frame) - 1);
+  EXPECT_EQ(commands(stream | views::packets), (std::vector<uint8_t>{0x01u}));
+  EXPECT_TRUE(empty(commands(std::vector<uint8_t>{} | views::packets)));
+}
+
+TEST(packets_view, composes) {
+  auto const stream{make_stream()};
+  auto valid{stream | views::packets |
+             std::views::filter([](auto const& p) { return p.has_value(); }) |
+             std::views::take(3)};
+  EXPECT_EQ(commands(valid), (std::vector<uint8_t>{0x01u, 0x02u, 0x02u}));
+}
+
+#if defined(__cpp_lib_generator) && __cpp_lib_generator >= 202207L
+TEST(packets_view, generator) {
+  EXPECT_EQ(commands(packet_generator(make_stream())), expected);
+}
+#endif
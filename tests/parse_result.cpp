@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+// ZUSI packet with checksum
+std::vector<uint8_t> packet(std::vector<uint8_t> bytes) {
+  bytes.push_back(zusi::crc8(bytes));
+  return bytes;
+}
+
+// SUSIV2 frame
+std::vector<uint8_t> frame(std::vector<uint8_t> const& packet,
+                           uint8_t flags = 0u) {
+  std::vector<uint8_t> frame{0x00u, 0x00u, 0x00u, 0x00u, flags};
+  frame.insert(cend(frame), cbegin(packet), cend(packet));
+  return frame;
+}
+
+std::vector<std::vector<uint8_t>> packets() {
+  std::vector<uint8_t> zppwrite{0x05u, 0x0Fu, 0x00u, 0x01u, 0x00u, 0x00u};
+  for (auto i{0u}; i < 16u; ++i) zppwrite.push_back(static_cast<uint8_t>(i));
+  return {packet({0x01u, 0x00u, 0x00u, 0x00u, 0x00u, 0x07u}),
+          packet({0x02u, 0x01u, 0x00u, 0x00u, 0x00u, 0x07u, 0x03u, 0x04u}),
+          packet({0x04u, 0x55u, 0xAAu}),
+          packet(zppwrite),
+          packet({0x06u}),
+          packet({0x07u, 0x55u, 0xAAu, 0x02u}),
+          packet({0x0Du, 0x00u, 0x00u, 0x00u, 0x00u})};
+}
+
+// Flat status equivalent to nested result
+template<typename T>
+Status status(std::expected<std::optional<T>, std::errc> const& result) {
+  if (!result) return result.error() == std::errc::not_supported
+                        ? Status::BadHeader
+                        : Status::Corrupt;
+  return *result ? Status::Ok : Status::Incomplete;
+}
+
+// Nested and flat API agree on a frame
+void expect_same(std::span<uint8_t const> f) {
+  auto const nested{frame2packet(f)};
+  auto const flat{flat::frame2packet(f)};
+  if (flat.status() == Status::UnknownCommand)
+    EXPECT_EQ(status(nested), Status::Corrupt);
+  else EXPECT_EQ(flat.status(), status(nested));
+  if (nested && *nested && flat) {
+    EXPECT_EQ(data(**nested), data(*flat));
+    EXPECT_EQ(size(**nested), size(*flat));
+  }
+
+  auto const p{f.subspan(std::min(header_size, size(f)))};
+  auto const count{get_count(p)};
+  auto const flat_count{flat::get_count(p)};
+  EXPECT_EQ(count.has_value(),
+            flat_count || flat_count.status() == Status::Incomplete);
+  if (count && *count && flat_count) {
+    EXPECT_EQ(**count, *flat_count);
+  }
+  auto const addr{get_address(p)};
+  auto const flat_addr{flat::get_address(p)};
+  EXPECT_EQ(addr.has_value(),
+            flat_addr || flat_addr.status() == Status::Incomplete);
+  if (addr && *addr && flat_addr) {
+    EXPECT_EQ(**addr, *flat_addr);
+  }
+}
+
+} // namespace
+
+TEST(parse_result, layout) {
+  static_assert(sizeof(ParseResult<uint8_t>) == 2uz);
+  static_assert(sizeof(ParseResult<zusi::Command>) == 2uz);
+  static_assert(sizeof(ParseResult<uint16_t>) == 4uz);
+  static_assert(sizeof(ParseResult<uint32_t>) == 8uz);
+  static_assert(sizeof(ParseResult<std::span<uint8_t const>>) <=
+                2uz * sizeof(void*));
+  static_assert(
+    std::is_trivially_copyable_v<ParseResult<std::span<uint8_t const>>>);
+}
+
+TEST(parse_result, frame2packet) {
+  for (auto const& p : packets()) {
+    auto const f{frame(p)};
+    auto const result{flat::frame2packet(f)};
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(std::ranges::equal(*result, p));
+    EXPECT_EQ(flat::validate(p), Status::Ok);
+    EXPECT_EQ(*flat::get_checksum(p), p.back());
+  }
+}
+
+TEST(parse_result, specific_status) {
+  auto const p{packets().front()};
+
+  // Every prefix is incomplete
+  auto const f{frame(p)};
+  for (auto i{0uz}; i < size(f); ++i)
+    EXPECT_EQ(flat::frame2packet(std::span{f}.first(i)).status(),
+              Status::Incomplete);
+
+  // Checksum mismatch
+  auto corrupt{f};
+  corrupt.back() ^= 0x01u;
+  EXPECT_EQ(flat::frame2packet(corrupt).status(), Status::Corrupt);
+
+  // Unknown command
+  auto unknown{f};
+  unknown[header_size] = 0xEEu;
+  EXPECT_EQ(flat::frame2packet(unknown).status(), Status::UnknownCommand);
+  EXPECT_EQ(flat::get_command(std::span{unknown}.subspan(header_size)).status(),
+            Status::UnknownCommand);
+
+  // Flags
+  for (auto const flags : {compressed_flag, multi_flag, sequence_flag})
+    EXPECT_EQ(flat::frame2packet(frame(p, flags)).status(), Status::BadHeader);
+
+  // Trailing bytes
+  auto longer{p};
+  longer.push_back(0x00u);
+  EXPECT_EQ(flat::validate(longer), Status::Corrupt);
+  EXPECT_EQ(flat::get_checksum(longer).status(), Status::Corrupt);
+  // Nested API keeps reporting them as incomplete
+  EXPECT_EQ(validate(longer), std::nullopt);
+  EXPECT_EQ(get_checksum(longer), std::nullopt);
+
+  // Fields a command doesn't have
+  auto const features{packets()[4uz]};
+  EXPECT_EQ(*flat::get_command(features), zusi::Command::Features);
+  EXPECT_EQ(flat::get_count(std::span{p}.first(1uz)).status(),
+            Status::Incomplete);
+  EXPECT_EQ(flat::get_count(features).status(), Status::UnknownCommand);
+  auto const query{packets()[6uz]};
+  EXPECT_EQ(flat::get_address(query).status(), Status::UnknownCommand);
+
+  EXPECT_EQ(to_errc(Status::BadHeader), std::errc::not_supported);
+  EXPECT_EQ(to_errc(Status::Corrupt), std::errc::protocol_error);
+}
+
+TEST(parse_result, same_as_nested) {
+  for (auto const& p : packets()) {
+    auto const f{frame(p)};
+    for (auto i{0uz}; i <= size(f); ++i) expect_same(std::span{f}.first(i));
+    for (auto i{header_size}; i < size(f); ++i) {
+      auto corrupt{f};
+      corrupt[i] ^= 0x10u;
+      expect_same(corrupt);
+    }
+    expect_same(frame(p, busy_flag));
+    expect_same(frame(p, multi_flag));
+  }
+}
@@ -0,0 +1,295 @@
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+std::vector<uint8_t> cvread_frame(uint32_t addr) {
+  std::vector<uint8_t> frame{0x00u, 0x00u, 0x00u, 0x01u, 0x01u, 0x01u, 0x00u};
+  frame.resize(header_size + cvread_size);
+  uint32_2data(addr, &frame[header_size + zusi::addr_pos]);
+  frame.back() = zusi::crc8(std::span{frame}.subspan(header_size, 6uz));
+  return frame;
+}
+
+std::vector<uint8_t> sequenced(std::span<uint8_t const> frame,
+                               uint8_t sequence) {
+  std::vector<uint8_t> out(size(frame) + 1uz);
+  add_sequence(frame, sequence, out);
+  return out;
+}
+
+// Pseudo terminal pair in raw mode
+struct Pty {
+  Pty() {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) || unlockpt(master)) return;
+    slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    termios tio{};
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+  }
+
+  ~Pty() {
+    if (slave >= 0) close(slave);
+    if (master >= 0) close(master);
+  }
+
+  int master{-1};
+  int slave{-1};
+};
+
+// Read whatever arrives within timeout
+std::vector<uint8_t> read_some(int fd, int timeout_ms) {
+  pollfd pfd{.fd = fd, .events = POLLIN, .revents = 0};
+  if (poll(&pfd, 1, timeout_ms) <= 0) return {};
+  std::vector<uint8_t> buf(256uz);
+  auto const n{read(fd, data(buf), size(buf))};
+  buf.resize(n > 0 ? static_cast<size_t>(n) : 0uz);
+  return buf;
+}
+
+// Receiver answering CvRead with the lowest address byte until Exit
+void receiver(int fd, std::vector<uint32_t>& executed) {
+  Decoder decoder;
+  Sequencer sequencer;
+  for (;;) {
+    auto const rx{read_some(fd, 2000)};
+    if (empty(rx)) return;
+    std::span<uint8_t const> chunk{rx};
+    while (!empty(chunk)) {
+      auto const packet{decoder.receive(chunk, 0u)};
+      if (!packet || !*packet) continue;
+      auto const cmd{**get_command(**packet)};
+      if (cmd == zusi::Command::Exit) return;
+      auto const order{sequencer.receive(*decoder.sequence())};
+      if (order == Order::Gap) continue;
+      // Duplicates are answered with nak
+      zusi::Feedback fb{std::unexpected{std::errc::protocol_error}};
+      if (order == Order::Next) {
+        auto const addr{**get_address(**packet)};
+        executed.push_back(addr);
+        fb = zusi::Feedback{{static_cast<uint8_t>(addr)}};
+      }
+      auto const resp{feedback2response(fb, *decoder.sequence())};
+      if (write(fd, std::data(resp), size(resp)) < 0) return;
+    }
+  }
+}
+
+// Read CVs through a window, the first transmission of the frame for CV
+// "corrupt" gets lost
+size_t host(int fd, size_t window, uint32_t count, uint32_t corrupt) {
+  Window win{window};
+  std::deque<uint32_t> unacked;
+  uint32_t next{};
+  size_t max_in_flight{};
+
+  while (next < count || !empty(unacked)) {
+    // Retransmit rewound frames first, then new ones
+    while (!win.full()) {
+      uint32_t addr{};
+      if (win.in_flight() < size(unacked)) addr = unacked[win.in_flight()];
+      else if (next < count) unacked.push_back(addr = next++);
+      else break;
+      auto frame{sequenced(cvread_frame(addr), *win.push(1u))};
+      if (addr == corrupt) {
+        frame.back() ^= 0xFFu;
+        corrupt = UINT32_MAX;
+      }
+      EXPECT_EQ(write(fd, data(frame), size(frame)),
+                static_cast<ssize_t>(size(frame)));
+      max_in_flight = std::max(max_in_flight, win.in_flight());
+    }
+
+    auto const tx{read_some(fd, 100)};
+    std::span<uint8_t const> chunk{tx};
+    if (empty(chunk)) win.rewind(); // Timeout
+    while (!empty(chunk)) {
+      auto const reply{win.receive(chunk)};
+      if (!reply) win.rewind();
+      else if (*reply) {
+        EXPECT_TRUE((*reply)->ack);
+        EXPECT_EQ((*reply)->data[0uz], static_cast<uint8_t>(unacked.front()));
+        unacked.pop_front();
+      }
+    }
+  }
+  return max_in_flight;
+}
+
+// Run host against receiver on a pseudo terminal
+size_t read_cvs(size_t window, uint32_t count, uint32_t corrupt) {
+  Pty pty;
+  EXPECT_GE(pty.slave, 0);
+  if (pty.slave < 0) return 0uz;
+  std::vector<uint32_t> executed;
+  std::thread rx{receiver, pty.slave, std::ref(executed)};
+  auto const max_in_flight{host(pty.master, window, count, corrupt)};
+  constexpr std::array<uint8_t, header_size + exit_size> exit{
+    0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x07u, 0x55u, 0xAAu, 0x02u, 0x7Du};
+  EXPECT_EQ(write(pty.master, data(exit), size(exit)),
+            static_cast<ssize_t>(size(exit)));
+  rx.join();
+
+  // Every frame executed exactly once and in order
+  EXPECT_EQ(size(executed), count);
+  for (auto i{0uz}; i < size(executed); ++i) EXPECT_EQ(executed[i], i);
+  return max_in_flight;
+}
+
+} // namespace
+
+TEST(pipeline, sequenced_frame) {
+  auto const frame{cvread_frame(42u)};
+  auto const seq_frame{sequenced(frame, 7u)};
+  EXPECT_EQ(size(seq_frame), size(frame) + 1uz);
+  EXPECT_EQ(get_sequence(seq_frame), 7u);
+  EXPECT_FALSE(get_sequence(frame));
+  EXPECT_EQ(frame2packet(seq_frame).error(), std::errc::not_supported);
+
+  Decoder decoder;
+  auto const packet{decoder.receive(seq_frame, 0u)};
+  ASSERT_TRUE(packet && *packet);
+  EXPECT_EQ(**get_address(**packet), 42u);
+  EXPECT_EQ(decoder.sequence(), 7u);
+
+  // Sequence number belongs to one frame only
+  EXPECT_FALSE(*decoder.receive({data(frame), 1uz}, 0u));
+  EXPECT_FALSE(decoder.sequence());
+}
+
+TEST(pipeline, sequenced_response) {
+  EXPECT_EQ(feedback2response(zusi::Feedback{}, 3u),
+            (SequencedResponse{3u, ack}));
+  EXPECT_EQ(feedback2response(zusi::Feedback{{42u}}, 3u),
+            (SequencedResponse{3u, ack, 42u, zusi::crc8(42u)}));
+  EXPECT_EQ(feedback2response(std::unexpected{std::errc{}}, 3u),
+            (SequencedResponse{3u, nak}));
+}
+
+TEST(pipeline, window) {
+  Window win{2uz};
+  EXPECT_EQ(win.push(0u), 0u);
+  EXPECT_EQ(win.push(1u), 1u);
+  EXPECT_FALSE(win.push(0u));
+  EXPECT_TRUE(win.full());
+
+  // Both responses in one chunk
+  std::vector<uint8_t> const rx{0u, ack, 1u, ack, 42u, zusi::crc8(42u)};
+  std::span<uint8_t const> chunk{rx};
+  auto reply{win.receive(chunk)};
+  ASSERT_TRUE(reply && *reply);
+  EXPECT_EQ((*reply)->sequence, 0u);
+  EXPECT_TRUE(empty((*reply)->data));
+  reply = win.receive(chunk);
+  ASSERT_TRUE(reply && *reply);
+  EXPECT_EQ((*reply)->sequence, 1u);
+  EXPECT_EQ((*reply)->data[0uz], 42u);
+  EXPECT_EQ(win.in_flight(), 0uz);
+  EXPECT_EQ(win.oldest(), 2u);
+}
+
+TEST(pipeline, window_gap_and_rewind) {
+  Window win{4uz};
+  for (auto i{0uz}; i < 4uz; ++i) win.push(0u);
+
+  // Response to frame 0 missing
+  EXPECT_FALSE(win.receive(std::vector<uint8_t>{1u, ack}));
+  EXPECT_EQ(win.rewind(), 4uz);
+  EXPECT_EQ(win.push(0u), 0u);
+  EXPECT_EQ(win.push(0u), 1u);
+
+  // Late response to frame 0 answers its retransmission, the response to the
+  // retransmission itself is skipped
+  std::vector<uint8_t> const rx{0u, ack, 0u, nak, 1u, ack};
+  std::span<uint8_t const> chunk{rx};
+  auto reply{win.receive(chunk)};
+  ASSERT_TRUE(reply && *reply);
+  EXPECT_EQ((*reply)->sequence, 0u);
+  EXPECT_TRUE((*reply)->ack);
+  reply = win.receive(chunk);
+  ASSERT_TRUE(reply && *reply);
+  EXPECT_EQ((*reply)->sequence, 1u);
+  EXPECT_TRUE(empty(chunk));
+}
+
+TEST(pipeline, window_exclusive) {
+  Window win{4uz};
+  EXPECT_EQ(win.push(0u), 0u);
+
+  // ZppErase has to wait until the window is drained
+  EXPECT_FALSE(win.push(0u, true));
+  ASSERT_TRUE(*win.receive(std::vector<uint8_t>{0u, ack}));
+  EXPECT_EQ(win.push(0u, true), 1u);
+
+  // Nothing follows until it has been answered
+  EXPECT_TRUE(win.full());
+  EXPECT_FALSE(win.push(0u));
+  ASSERT_TRUE(*win.receive(std::vector<uint8_t>{1u, ack}));
+  EXPECT_FALSE(win.full());
+  EXPECT_EQ(win.push(0u), 2u);
+
+  // Rewinding an exclusive frame only resends that frame
+  Window rewound{4uz};
+  rewound.push(0u, true);
+  EXPECT_EQ(rewound.rewind(), 1uz);
+  EXPECT_FALSE(rewound.full());
+}
+
+TEST(pipeline, window_corrupt_response) {
+  Window win;
+  win.push(1u);
+  EXPECT_FALSE(win.receive(std::vector<uint8_t>{0u, ack, 42u, 0x00u}));
+  EXPECT_FALSE(win.receive(std::vector<uint8_t>{0u, 0x42u}));
+}
+
+TEST(pipeline, sequencer_gap) {
+  Sequencer sequencer;
+
+  // Frame 2 of the window 0-5 lost
+  EXPECT_EQ(sequencer.receive(0u), Order::Next);
+  EXPECT_EQ(sequencer.receive(1u), Order::Next);
+  for (uint8_t i{3u}; i < 6u; ++i) EXPECT_EQ(sequencer.receive(i), Order::Gap);
+  EXPECT_EQ(sequencer.expected(), 2u);
+
+  // Retransmission after rewind
+  for (uint8_t i{2u}; i < 6u; ++i) EXPECT_EQ(sequencer.receive(i), Order::Next);
+
+  // Response to frame 5 lost, frame 5 is retransmitted
+  EXPECT_EQ(sequencer.receive(5u), Order::Duplicate);
+  EXPECT_EQ(sequencer.expected(), 6u);
+
+  sequencer.reset();
+  EXPECT_EQ(sequencer.receive(0u), Order::Next);
+}
+
+TEST(pipeline, sequencer_wraps) {
+  Sequencer sequencer;
+  for (auto i{0uz}; i < 300uz; ++i)
+    EXPECT_EQ(sequencer.receive(static_cast<uint8_t>(i)), Order::Next);
+  EXPECT_EQ(sequencer.receive(static_cast<uint8_t>(300uz - max_window_size)),
+            Order::Duplicate);
+  EXPECT_EQ(
+    sequencer.receive(static_cast<uint8_t>(300uz + max_window_size - 1uz)),
+    Order::Gap);
+}
+
+TEST(pipeline, pty) { EXPECT_EQ(read_cvs(8uz, 300u, UINT32_MAX), 8uz); }
+
+TEST(pipeline, pty_lost_frame) { EXPECT_EQ(read_cvs(8uz, 100u, 37u), 8uz); }
+
+TEST(pipeline, pty_stop_and_wait) {
+  EXPECT_EQ(read_cvs(1uz, 20u, 5u), 1uz);
+}
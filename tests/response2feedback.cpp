@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+TEST(response2feedback, ack_without_data) {
+  auto const fb{response2feedback(Response{ack}, 0u)};
+  ASSERT_TRUE(fb && *fb);
+  EXPECT_TRUE(empty(**fb));
+}
+
+TEST(response2feedback, nak) {
+  EXPECT_EQ(response2feedback(Response{nak}, 1u).error(), std::errc::io_error);
+}
+
+TEST(response2feedback, cv_feedback) {
+  Response const resp{ack, 42u, zusi::crc8(42u)};
+  auto const fb{response2feedback(resp, 1u)};
+  ASSERT_TRUE(fb && *fb);
+  ASSERT_EQ(size(**fb), 1uz);
+  EXPECT_EQ((**fb)[0uz], 42u);
+  // No copy
+  EXPECT_EQ(data(**fb), &resp[1uz]);
+}
+
+TEST(response2feedback, answer_length_from_frame) {
+  std::array<uint8_t, header_size> const frame{0x00u, 0x00u, 0x00u, 0x01u};
+  EXPECT_TRUE(*response2feedback(Response{ack, 42u, zusi::crc8(42u)}, frame));
+  EXPECT_FALSE(response2feedback(Response{ack, 42u, zusi::crc8(42u)},
+                                 std::span{frame}.first(2uz)));
+}
+
+TEST(response2feedback, incomplete_and_corrupt) {
+  EXPECT_FALSE(*response2feedback(Response{}, 1u));
+  EXPECT_FALSE(*response2feedback(Response{ack, 42u}, 1u));
+  EXPECT_EQ(response2feedback(Response{ack, 42u, 0x00u}, 1u).error(),
+            std::errc::protocol_error);
+  EXPECT_EQ(response2feedback(Response{0x42u}, 1u).error(),
+            std::errc::protocol_error);
+}
+
+TEST(response2feedback, decoder_byte_by_byte) {
+  Response crc_resp{ack, 0xFBu, 0xFFu, 0xFFu, 0x7Fu, 0x00u};
+  crc_resp.back() =
+    zusi::crc8(std::span<uint8_t const>{crc_resp}.subspan(1uz, 4uz));
+
+  ResponseDecoder decoder{4u};
+  for (auto i{0uz}; i < size(crc_resp) - 1uz; ++i) {
+    EXPECT_FALSE(*decoder.receive({&crc_resp[i], 1uz}));
+    EXPECT_EQ(decoder.pending(), i + 1uz);
+  }
+  auto const fb{decoder.receive({&crc_resp.back(), 1uz})};
+  ASSERT_TRUE(fb && *fb);
+  EXPECT_TRUE(std::ranges::equal(
+    **fb, std::span<uint8_t const>{crc_resp}.subspan(1uz, 4uz)));
+}
+
+TEST(response2feedback, decoder_consumes_one_response) {
+  std::vector<uint8_t> const rx{ack, 42u, zusi::crc8(42u), nak};
+  std::span<uint8_t const> chunk{rx};
+  ResponseDecoder decoder{1u};
+  auto const fb{decoder.receive(chunk)};
+  ASSERT_TRUE(fb && *fb);
+  EXPECT_EQ((**fb)[0uz], 42u);
+  EXPECT_EQ(size(chunk), 1uz);
+
+  decoder.expect(0u);
+  EXPECT_EQ(decoder.receive(chunk).error(), std::errc::io_error);
+  EXPECT_TRUE(empty(chunk));
+}
+
+TEST(response2feedback, decoder_corrupt) {
+  ResponseDecoder decoder{1u};
+  EXPECT_EQ(decoder.receive(std::vector<uint8_t>{ack, 42u, 0x00u}).error(),
+            std::errc::protocol_error);
+  decoder.expect(1u);
+  EXPECT_EQ(decoder.receive(std::vector<uint8_t>{0x42u}).error(),
+            std::errc::protocol_error);
+
+  // Answer doesn't fit into response
+  decoder.expect(ULF_SUSIV2_MAX_RESPONSE_SIZE);
+  EXPECT_EQ(decoder.receive(std::vector<uint8_t>{ack}).error(),
+            std::errc::message_size);
+}
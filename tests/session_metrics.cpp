@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "ulf/susiv2/session_metrics.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+std::string prometheus(SessionSnapshot const& s,
+                       std::string_view labels = {}) {
+  std::string str;
+  write_prometheus(s, [&](std::string_view piece) { str += piece; }, labels);
+  return str;
+}
+
+} // namespace
+
+TEST(session_metrics, snapshot) {
+  SessionMetrics metrics;
+  metrics.start(1'000'000u, 1024u);
+  metrics.record({.cmd = zusi::Command::ZppErase,
+                  .ack = true,
+                  .bytes = 10u,
+                  .rtt = 400'000u,
+                  .busy = 390'000u});
+  for (auto i{0u}; i < 3u; ++i)
+    metrics.record({.cmd = zusi::Command::ZppWrite,
+                    .ack = i != 1u,
+                    .bytes = 270u,
+                    .rtt = 5'000u,
+                    .busy = 700u,
+                    .progress = i != 1u ? 256u : 0u});
+
+  auto const s{metrics.snapshot(2'000'000u)};
+  EXPECT_EQ(s.elapsed, 1'000'000u);
+  EXPECT_EQ(s.frames, 4u);
+  EXPECT_EQ(s.bytes, 820u);
+  EXPECT_EQ(s.busy, 392'100u);
+  EXPECT_EQ(s.rtt_sum, 415'000u);
+  EXPECT_EQ(s.rtt[5uz], 3u);  // <= 5ms
+  EXPECT_EQ(s.rtt[11uz], 1u); // <= 500ms
+  EXPECT_EQ(s.acks[0x04uz], 1u);
+  EXPECT_EQ(s.acks[0x05uz], 2u);
+  EXPECT_EQ(s.naks[0x05uz], 1u);
+  EXPECT_DOUBLE_EQ(s.bytes_per_second(), 820.0);
+  EXPECT_DOUBLE_EQ(s.frames_per_second(), 4.0);
+
+  // Half done after 1s
+  ASSERT_TRUE(s.eta());
+  EXPECT_EQ(*s.eta(), 1'000'000u);
+
+  // Restart clears everything
+  metrics.start(3'000'000u);
+  auto const r{metrics.snapshot(3'000'000u)};
+  EXPECT_EQ(r.frames, 0u);
+  EXPECT_EQ(r.acks[0x05uz], 0u);
+  EXPECT_FALSE(r.eta());
+}
+
+TEST(session_metrics, rtt_bucket_bounds_are_inclusive) {
+  SessionMetrics metrics;
+  metrics.start(0u);
+  metrics.record({.rtt = 100u});
+  metrics.record({.rtt = 101u});
+  metrics.record({.rtt = 1'000'000u});
+  auto const s{metrics.snapshot(0u)};
+  EXPECT_EQ(s.rtt[0uz], 1u);
+  EXPECT_EQ(s.rtt[1uz], 1u);
+  EXPECT_EQ(s.rtt.back(), 1u);
+}
+
+TEST(session_metrics, prometheus) {
+  SessionMetrics metrics;
+  metrics.start(0u, 512u);
+  metrics.record({.cmd = zusi::Command::ZppWrite,
+                  .ack = true,
+                  .bytes = 270u,
+                  .rtt = 2'000u,
+                  .progress = 256u});
+  metrics.record({.cmd = zusi::Command::CvRead, .bytes = 8u, .rtt = 300u});
+  auto const str{prometheus(metrics.snapshot(1'000'000u), R"(station="7")")};
+
+  EXPECT_NE(str.find("# TYPE ulf_susiv2_frames_total counter\n"
+                     "ulf_susiv2_frames_total{station=\"7\"} 2\n"),
+            std::string::npos);
+  EXPECT_NE(str.find("ulf_susiv2_bytes_per_second{station=\"7\"} 278\n"),
+            std::string::npos);
+
+  // Cumulative buckets
+  EXPECT_NE(str.find("ulf_susiv2_rtt_seconds_bucket{station=\"7\",le=\"0.00025"
+                     "\"} 0\n"),
+            std::string::npos);
+  EXPECT_NE(
+    str.find("ulf_susiv2_rtt_seconds_bucket{station=\"7\",le=\"0.0005\"} 1\n"),
+    std::string::npos);
+  EXPECT_NE(
+    str.find("ulf_susiv2_rtt_seconds_bucket{station=\"7\",le=\"+Inf\"} 2\n"),
+    std::string::npos);
+  EXPECT_NE(str.find("ulf_susiv2_rtt_seconds_count{station=\"7\"} 2\n"),
+            std::string::npos);
+
+  // Only commands which occurred
+  EXPECT_NE(str.find("ulf_susiv2_responses_total{station=\"7\",command="
+                     "\"ZppWrite\",response=\"ack\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(str.find("command=\"CvRead\",response=\"nak\"} 1\n"),
+            std::string::npos);
+  EXPECT_EQ(str.find("command=\"CvWrite\""), std::string::npos);
+
+  EXPECT_NE(str.find("ulf_susiv2_progress_ratio{station=\"7\"} 0.5\n"),
+            std::string::npos);
+  EXPECT_NE(str.find("ulf_susiv2_eta_seconds{station=\"7\"} 1\n"),
+            std::string::npos);
+}
+
+TEST(session_metrics, prometheus_without_labels) {
+  SessionMetrics metrics;
+  metrics.start(0u);
+  auto const str{prometheus(metrics.snapshot(0u))};
+  EXPECT_NE(str.find("ulf_susiv2_frames_total 0\n"), std::string::npos);
+  EXPECT_NE(str.find("ulf_susiv2_rtt_seconds_bucket{le=\"+Inf\"} 0\n"),
+            std::string::npos);
+  EXPECT_EQ(str.find("responses_total{"), std::string::npos);
+  EXPECT_EQ(str.find("eta_seconds"), std::string::npos);
+}
+
+TEST(session_metrics, snapshots_are_consistent) {
+  SessionMetrics metrics;
+  metrics.start(0u);
+  std::atomic<bool> reading{}, done{};
+  std::jthread writer{[&] {
+    while (!reading) std::this_thread::yield();
+    for (auto i{0u}; i < 100'000u; ++i)
+      metrics.record({.cmd = zusi::Command::ZppWrite,
+                      .ack = i % 7u != 0u,
+                      .bytes = 270u,
+                      .rtt = i % 1'000u});
+    done = true;
+  }};
+
+  size_t snapshots{};
+  reading = true;
+  do {
+    auto const s{metrics.snapshot(0u)};
+    ASSERT_EQ(s.bytes, s.frames * 270u);
+    ASSERT_EQ(s.acks[0x05uz] + s.naks[0x05uz], s.frames);
+    uint64_t count{};
+    for (auto const n : s.rtt) count += n;
+    ASSERT_EQ(count, s.frames);
+    ++snapshots;
+  } while (!done);
+  EXPECT_GT(snapshots, 0uz);
+  EXPECT_EQ(metrics.snapshot(0u).frames, 100'000u);
+}
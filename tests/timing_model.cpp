@@ -0,0 +1,344 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <vector>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+std::vector<uint8_t> cvread_frame(uint32_t addr) {
+  std::vector<uint8_t> frame{0x00u, 0x00u, 0x00u, 0x01u, 0x01u, 0x01u, 0x00u};
+  frame.resize(header_size + cvread_size);
+  uint32_2data(addr, &frame[header_size + zusi::addr_pos]);
+  frame.back() = zusi::crc8(std::span{frame}.subspan(header_size, 6uz));
+  return frame;
+}
+
+std::vector<uint8_t> zpperase_frame() {
+  std::vector<uint8_t> frame{
+    0x00u, 0x00u, 0x00u, 0x00u, 0x01u, 0x04u, 0x55u, 0xAAu, 0x00u};
+  frame.back() = zusi::crc8(std::span{frame}.subspan(header_size, 3uz));
+  return frame;
+}
+
+std::vector<uint8_t> zppwrite_frame(uint32_t addr, size_t n) {
+  std::vector<uint8_t> data(n);
+  for (auto i{0uz}; i < n; ++i) data[i] = static_cast<uint8_t>(addr + i);
+  std::array<uint8_t, header_size + max_zppwrite_size> buf;
+  auto const frame{zppwrite2frame(addr, data, buf, 0u, false)};
+  return {cbegin(frame), cend(frame)};
+}
+
+std::vector<std::vector<uint8_t>> zpp_update(size_t image_size, size_t chunk) {
+  std::vector<std::vector<uint8_t>> frames{zpperase_frame()};
+  for (auto i{0uz}; i < image_size; i += chunk)
+    frames.push_back(zppwrite_frame(static_cast<uint32_t>(i),
+                                    std::min(chunk, image_size - i)));
+  return frames;
+}
+
+// Event-driven simulation of a session
+//
+// Host and receiver only react to events: a byte leaving a UART, a packet
+// being executed or the host reacting to a response. Bytes are queued in the
+// FIFOs of the UARTs. The receiver loop feeds received bytes through a Decoder
+// and executes a packet whenever it's idle. Responses are built from ZUSI
+// feedback and decoded by a ResponseDecoder (stop-and-wait) or a Window
+// (pipelined). The host starts a new frame whenever the line is idle and less
+// than window frames await their reply.
+double simulate(std::vector<std::vector<uint8_t>> const& frames,
+                LinkTiming link,
+                BusyTiming busy,
+                size_t window) {
+  enum class Event { HostTx, Executed, ReceiverTx, HostReacted };
+  using Entry = std::tuple<double, size_t, Event>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> events;
+  size_t order{};
+  auto const schedule{[&](double t, Event e) {
+    events.push({t, order++, e});
+  }};
+  auto const byte_us{10e6 / link.baud};
+  double now{}, last{};
+
+  // Host
+  size_t next{}, outstanding{};
+  std::deque<uint8_t> host_tx;
+  bool host_tx_busy{};
+  ResponseDecoder response_decoder;
+  Window w{window};
+
+  // Receiver
+  Decoder decoder;
+  std::deque<uint8_t> rx, receiver_tx;
+  bool executing{}, receiver_tx_busy{};
+  std::optional<zusi::Command> cmd;
+  std::optional<uint8_t> seq;
+  std::vector<std::optional<uint8_t>> sequences;
+
+  auto const host_send{[&] {
+    if (host_tx_busy) return;
+    if (empty(host_tx) && next < size(frames) && outstanding < window) {
+      auto const& f{frames[next++]};
+      auto const answer_length{*get_answer_length(f)};
+      ++outstanding;
+      if (window > 1uz) {
+        EXPECT_FALSE(w.full());
+        std::vector<uint8_t> frame(size(f) + 1uz);
+        add_sequence(f, *w.push(answer_length), frame);
+        host_tx.assign(cbegin(frame), cend(frame));
+      } else {
+        response_decoder.expect(answer_length);
+        host_tx.assign(cbegin(f), cend(f));
+      }
+    }
+    if (empty(host_tx)) return;
+    host_tx_busy = true;
+    schedule(now + byte_us, Event::HostTx);
+  }};
+
+  auto const receiver_send{[&] {
+    if (receiver_tx_busy || empty(receiver_tx)) return;
+    receiver_tx_busy = true;
+    schedule(now + byte_us, Event::ReceiverTx);
+  }};
+
+  auto const receiver_loop{[&] {
+    while (!executing && !empty(rx)) {
+      auto const byte{rx.front()};
+      rx.pop_front();
+      auto const packet{decoder.receive({&byte, 1uz}, 0u)};
+      EXPECT_TRUE(packet);
+      if (!packet || !*packet) continue;
+      cmd = static_cast<zusi::Command>((**packet)[zusi::cmd_pos]);
+      seq = decoder.sequence();
+      executing = true;
+      auto const& f{frames[size(sequences)]};
+      sequences.push_back(seq);
+      schedule(now + link.turnaround +
+                 (*get_flags(f) & busy_flag ? busy(std::to_underlying(*cmd))
+                                            : 0u),
+               Event::Executed);
+    }
+  }};
+
+  host_send();
+  while (!empty(events)) {
+    auto const [t, _, e] = events.top();
+    events.pop();
+    now = t;
+    switch (e) {
+      case Event::HostTx:
+        rx.push_back(host_tx.front());
+        host_tx.pop_front();
+        host_tx_busy = false;
+        receiver_loop();
+        host_send();
+        break;
+      case Event::Executed: {
+        auto const& f{frames[size(sequences) - 1uz]};
+        zusi::Feedback fb{};
+        for (auto j{0u}; j < *get_answer_length(f); ++j) fb->push_back(0u);
+        if (seq) {
+          auto const r{feedback2response(fb, *seq)};
+          receiver_tx.insert(cend(receiver_tx),
+                             std::ranges::begin(r),
+                             std::ranges::end(r));
+        } else {
+          auto const r{feedback2response(fb)};
+          receiver_tx.insert(cend(receiver_tx),
+                             std::ranges::begin(r),
+                             std::ranges::end(r));
+        }
+        executing = false;
+        receiver_send();
+        receiver_loop();
+        break;
+      }
+      case Event::ReceiverTx: {
+        auto const byte{receiver_tx.front()};
+        receiver_tx.pop_front();
+        receiver_tx_busy = false;
+        std::span<uint8_t const> chunk{&byte, 1uz};
+        auto done{false};
+        if (window > 1uz) {
+          auto const reply{w.receive(chunk)};
+          EXPECT_TRUE(reply);
+          done = reply && *reply;
+        } else {
+          auto const data{response_decoder.receive(chunk)};
+          EXPECT_TRUE(data);
+          done = data && *data;
+        }
+        if (done) schedule(now + link.latency, Event::HostReacted);
+        receiver_send();
+        break;
+      }
+      case Event::HostReacted:
+        --outstanding;
+        last = now;
+        host_send();
+        break;
+    }
+  }
+
+  EXPECT_EQ(next, size(frames));
+  EXPECT_EQ(size(sequences), size(frames));
+  return last;
+}
+
+double relative(uint64_t estimate, double simulated) {
+  return std::abs(static_cast<double>(estimate) - simulated) / simulated;
+}
+
+} // namespace
+
+TEST(timing_model, frame_shape) {
+  // CvRead with 1 byte answer
+  auto const cvread{get_frame_shape(cvread_frame(8u))};
+  ASSERT_TRUE(cvread);
+  EXPECT_EQ(cvread->frame_size, header_size + cvread_size);
+  EXPECT_EQ(cvread->response_size, 3uz);
+  EXPECT_FALSE(cvread->sequenced);
+
+  // ZppWrite
+  BusyTiming const busy{.zppwrite = 1'234u};
+  auto const zppwrite{get_frame_shape(zppwrite_frame(0u, 256uz), busy)};
+  ASSERT_TRUE(zppwrite);
+  EXPECT_EQ(zppwrite->frame_size, header_size + max_zppwrite_size);
+  EXPECT_EQ(zppwrite->response_size, 1uz);
+  EXPECT_EQ(zppwrite->busy, 1'234u);
+
+  // Busy flag cleared
+  auto no_busy{zppwrite_frame(0u, 16uz)};
+  no_busy[flags_pos] = 0u;
+  EXPECT_EQ(get_frame_shape(no_busy, busy)->busy, 0u);
+
+  // Sequenced
+  auto const f{cvread_frame(8u)};
+  std::vector<uint8_t> seq(size(f) + 1uz);
+  add_sequence(f, 42u, seq);
+  auto const sequenced{get_frame_shape(seq)};
+  ASSERT_TRUE(sequenced);
+  EXPECT_TRUE(sequenced->sequenced);
+  EXPECT_EQ(sequenced->frame_size, size(f) + 1uz);
+  EXPECT_EQ(sequenced->response_size, 4uz);
+
+  // Incomplete
+  EXPECT_FALSE(get_frame_shape(std::span{f}.first(size(f) - 1uz)));
+  EXPECT_FALSE(get_frame_shape(std::span{f}.first(header_size)));
+}
+
+TEST(timing_model, frame_shape_multi) {
+  MultiFrame multi;
+  auto const a{cvread_frame(8u)};
+  auto const b{zppwrite_frame(0u, 4uz)};
+  ASSERT_TRUE(multi.push_back(std::span{a}.subspan(header_size), 1u, false));
+  ASSERT_TRUE(multi.push_back(std::span{b}.subspan(header_size), 0u, true));
+  ASSERT_TRUE(multi.push_back(std::span{a}.subspan(header_size), 1u, false));
+
+  auto const shape{get_frame_shape(multi.frame(), {.cvread = 10u})};
+  ASSERT_TRUE(shape);
+  EXPECT_EQ(shape->frame_size, size(multi.frame()));
+  // 3 acks, 2 data bytes, 2 CRC8
+  EXPECT_EQ(shape->response_size, 7uz);
+  EXPECT_EQ(shape->busy, 10u + 700u + 10u);
+}
+
+TEST(timing_model, stop_and_wait) {
+  LinkTiming const link{.baud = 100'000u, .latency = 1'000u, .turnaround = 50u};
+  BusyTiming const busy{.zppwrite = 700u};
+  TimingModel model{link, busy};
+  auto const frame{zppwrite_frame(0u, 256uz)};
+  for (auto i{0uz}; i < 10uz; ++i) ASSERT_TRUE(model.push(frame));
+
+  // Every frame costs transmit + turnaround + busy + response + latency
+  auto const e{model.estimate()};
+  EXPECT_EQ(e.frames, 10uz);
+  EXPECT_EQ(e.frame_bytes, 10u * size(frame));
+  EXPECT_EQ(e.response_bytes, 10u);
+  EXPECT_EQ(e.total, 10u * (size(frame) * 100u + 50u + 700u + 100u + 1'000u));
+  EXPECT_EQ(e.critical_path.transmit, 10u * size(frame) * 100u);
+  EXPECT_EQ(e.critical_path.busy, 7'000u);
+  EXPECT_EQ(e.critical_path.latency, 10'000u);
+}
+
+TEST(timing_model, matches_simulation) {
+  LinkTiming const link{.baud = 115'200u, .latency = 1'000u, .turnaround = 20u};
+  BusyTiming const busy{};
+  auto frames{zpp_update(16'384uz, 256uz)};
+  for (auto i{0u}; i < 16u; ++i) frames.push_back(cvread_frame(i));
+
+  for (auto const window : {1uz, 2uz, 4uz, 16uz}) {
+    auto const simulated{simulate(frames, link, busy, window)};
+    auto const e{estimate(frames, link, busy, window)};
+    EXPECT_LT(relative(e.total, simulated), 0.01) << "window " << window;
+  }
+}
+
+TEST(timing_model, pipelining_hides_latency) {
+  LinkTiming const link{};
+  BusyTiming const busy{};
+  auto const frames{zpp_update(65'536uz, 256uz)};
+  auto const stop_and_wait{estimate(frames, link, busy)};
+  auto const pipelined{estimate(frames, link, busy, 4uz)};
+  EXPECT_LT(pipelined.total, stop_and_wait.total);
+
+  // Latency is off the critical path, transmitting is all that is left
+  EXPECT_EQ(pipelined.critical_path.latency, link.latency);
+  EXPECT_GT(pipelined.critical_path.transmit, pipelined.total * 9u / 10u);
+
+  // Critical path adds up to total
+  for (auto const& e : {stop_and_wait, pipelined}) {
+    auto const& p{e.critical_path};
+    EXPECT_NEAR(static_cast<double>(p.transmit + p.turnaround + p.busy +
+                                    p.response + p.latency),
+                static_cast<double>(e.total),
+                5.0);
+  }
+}
+
+TEST(timing_model, larger_frames_are_faster) {
+  auto const small{estimate_zpp(65'536uz, 64uz)};
+  auto const large{estimate_zpp(65'536uz, 256uz)};
+  EXPECT_EQ(small.frames, 1uz + 1'024uz);
+  EXPECT_EQ(large.frames, 1uz + 256uz);
+  EXPECT_LT(large.total, small.total);
+  EXPECT_LT(large.critical_path.latency, small.critical_path.latency);
+
+  // Same as building the frames
+  auto const frames{zpp_update(65'536uz, 256uz)};
+  EXPECT_EQ(large.total, estimate(frames).total);
+}
+
+TEST(timing_model, eta) {
+  auto const frames{zpp_update(4'096uz, 256uz)};
+  auto const total{estimate(frames)};
+  UpdateEta eta{total};
+  EXPECT_EQ(eta.remaining(), total.total);
+  EXPECT_DOUBLE_EQ(eta.progress(), 0.0);
+
+  // Half done, but twice as slow as predicted
+  auto const half{size(frames) / 2uz};
+  TimingModel model;
+  for (auto i{0uz}; i < half; ++i) {
+    model.push(frames[i]);
+    eta.done(frames[i], 2u * model.estimate().total);
+  }
+  auto const predicted{model.estimate().total};
+  EXPECT_NEAR(static_cast<double>(eta.remaining()),
+              2.0 * static_cast<double>(total.total - predicted),
+              1.0);
+  EXPECT_NEAR(eta.progress(),
+              static_cast<double>(predicted) /
+                static_cast<double>(total.total),
+              1e-9);
+
+  // Done
+  for (auto i{half}; i < size(frames); ++i) eta.done(frames[i], 0u);
+  EXPECT_EQ(eta.remaining(), 0u);
+  EXPECT_DOUBLE_EQ(eta.progress(), 1.0);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include <zusi/crc8.hpp>
+#include "ulf/susiv2.hpp"
+
+using namespace ulf::susiv2;
+
+namespace {
+
+std::vector<std::vector<uint8_t>> random_frames(size_t n) {
+  std::mt19937 gen{42u};
+  std::uniform_int_distribution<uint32_t> byte{0u, 255u};
+  std::vector<std::vector<uint8_t>> frames;
+  for (auto i{0uz}; i < n; ++i) {
+    std::vector<uint8_t> frame;
+    switch (i % 4uz) {
+      case 0uz: frame = {0x01u, 0x00u, 0x00u, 0x00u, 0x00u, 0xFFu}; break;
+      case 1uz: frame = {0x07u, 0x55u, 0xAAu, 0x00u}; break;
+      default:
+        frame = {0x05u, static_cast<uint8_t>(byte(gen))};
+        for (auto j{0uz}; j < 4uz + frame[1uz] + 1uz; ++j)
+          frame.push_back(static_cast<uint8_t>(byte(gen)));
+        break;
+    }
+    frame.push_back(zusi::crc8(frame));
+    // Corrupt every 5th frame, truncate every 7th
+    if (!(i % 5uz)) frame[byte(gen) % size(frame)] ^= 0x10u;
+    if (!(i % 7uz)) frame.pop_back();
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+// Buffers long enough for the vector loop, with lengths off by a few bytes
+std::vector<std::vector<uint8_t>> random_buffers(size_t n) {
+  std::mt19937 gen{42u};
+  std::uniform_int_distribution<uint32_t> byte{0u, 255u};
+  std::vector<std::vector<uint8_t>> buffers;
+  for (auto i{0uz}; i < n; ++i) {
+    std::vector<uint8_t> buffer;
+    for (auto j{0uz}; j < 32uz + byte(gen) % 64uz; ++j)
+      buffer.push_back(static_cast<uint8_t>(byte(gen)));
+    buffers.push_back(buffer);
+  }
+  return buffers;
+}
+
+} // namespace
+
+TEST(validate_batch, crc8_batch_scalar_matches_zusi) {
+  auto const buffers{random_buffers(37uz)};
+  std::vector<std::span<uint8_t const>> spans{cbegin(buffers), cend(buffers)};
+  std::vector<uint8_t> crcs(size(spans));
+  crc8_batch_scalar(spans, crcs);
+  for (auto i{0uz}; i < size(spans); ++i)
+    EXPECT_EQ(crcs[i], zusi::crc8(spans[i]));
+}
+
+#if defined(ULF_SUSIV2_CRC8_SSSE3)
+TEST(validate_batch, crc8_batch_ssse3_matches_zusi) {
+  if (!__builtin_cpu_supports("ssse3")) GTEST_SKIP() << "No SSSE3";
+  // 3 vectors of 16 buffers plus a remainder for the scalar path
+  auto const buffers{random_buffers(53uz)};
+  std::vector<std::span<uint8_t const>> spans{cbegin(buffers), cend(buffers)};
+  std::vector<uint8_t> crcs(size(spans));
+  crc8_batch_ssse3(spans, crcs);
+  for (auto i{0uz}; i < size(spans); ++i)
+    EXPECT_EQ(crcs[i], zusi::crc8(spans[i]));
+}
+#endif
+
+TEST(validate_batch, crc8_batch_matches_zusi) {
+  auto const frames{random_frames(37uz)};
+  std::vector<std::span<uint8_t const>> spans{cbegin(frames), cend(frames)};
+  std::vector<uint8_t> crcs(size(spans));
+  crc8_batch(spans, crcs);
+  for (auto i{0uz}; i < size(spans); ++i)
+    EXPECT_EQ(crcs[i], zusi::crc8(spans[i]));
+}
+
+TEST(validate_batch, matches_validate) {
+  auto const frames{random_frames(203uz)};
+  std::vector<std::span<uint8_t const>> spans{cbegin(frames), cend(frames)};
+  std::vector<uint32_t> bitmap((size(spans) + 31uz) / 32uz, 0xFFFF'FFFFu);
+  auto const count{validate_batch(spans, bitmap)};
+
+  size_t expected_count{};
+  for (auto i{0uz}; i < size(spans); ++i) {
+    auto const valid{validate(spans[i])};
+    bool const expected{valid && *valid && **valid};
+    expected_count += expected;
+    EXPECT_EQ(static_cast<bool>(bitmap[i / 32uz] & (1u << (i % 32uz))),
+              expected)
+      << "Frame " << i;
+  }
+  EXPECT_EQ(count, expected_count);
+  EXPECT_GT(count, 0uz);
+  EXPECT_LT(count, size(spans));
+}
+
+TEST(validate_batch, empty) {
+  EXPECT_EQ(validate_batch({}, {}), 0uz);
+}